@@ -0,0 +1,943 @@
+#include "ast.h"
+#include "data.h"
+#include "symbol.h"
+#include <string.h>
+#include <stdlib.h>
+
+/**
+ * The state of a single run of buildAst(). The symbols of the symbol table
+ * .. refer to their declaration nodes through their address field.
+ * */
+typedef struct {
+    TokenListIterator tokenListIt;
+    unsigned int currentLevel;
+    SymbolTable symbolTable;
+    Ast* ast;
+
+    // The number of variables declared so far in the block being parsed
+    int numberOfVariables;
+} AstBuilder;
+
+/**
+ * Functions used for non-terminals of the grammar. Each one parses the
+ * .. non-terminal at the current token and returns 0 on success, the code
+ * .. generator error code otherwise.
+ *
+ * The node parameter is set to the index of the node built, -1 if nothing
+ * .. was built (an empty statement). The declarations append their nodes to
+ * .. the list given by its first and last node.
+ * */
+int parseProgram(AstBuilder* b);
+int parseBlock(AstBuilder* b, int* node);
+int parseConstDeclaration(AstBuilder* b, int* first, int* last);
+int parseVarDeclaration(AstBuilder* b, int* first, int* last);
+int parseProcDeclaration(AstBuilder* b, int* first, int* last);
+int parseStatement(AstBuilder* b, int* node);
+int parseCondition(AstBuilder* b, int* node);
+int parseExpression(AstBuilder* b, int* node);
+int parseTerm(AstBuilder* b, int* node);
+int parseFactor(AstBuilder* b, int* node);
+
+/******************************************************************************/
+/* Definitions of helper functions starts *************************************/
+/******************************************************************************/
+
+static Token currentToken(AstBuilder* b)
+{
+    return getCurrentTokenFromIterator(b->tokenListIt);
+}
+
+static int currentTokenType(AstBuilder* b)
+{
+    return currentToken(b).id;
+}
+
+static void nextToken(AstBuilder* b)
+{
+    b->tokenListIt.currentTokenInd++;
+}
+
+/**
+ * Appends a node of the given kind and sets node to its index. Returns 0 on
+ * .. success, 20 if the node could not be allocated.
+ * */
+static int addNode(AstBuilder* b, AstNodeKind kind, int* node)
+{
+    *node = newAstNode(b->ast, kind);
+
+    return *node < 0 ? 20 : 0;
+}
+
+/**
+ * Appends the given node to the list given by its first and last node.
+ * */
+static void appendToList(Ast* ast, int* first, int* last, int node)
+{
+    if(*last < 0)
+        *first = node;
+    else
+        getAstNode(ast, *last)->next = node;
+
+    *last = node;
+}
+
+/**
+ * Declares the current identifier token as a symbol of the given type, whose
+ * .. declaration is the given node.
+ * */
+static Symbol* declare(AstBuilder* b, SymbolType type, int node)
+{
+    Symbol symbol;
+
+    symbol.type = type;
+    strcpy(symbol.name, currentToken(b).lexeme);
+    symbol.value = 0;
+    symbol.level = b->currentLevel;
+    symbol.address = node;
+
+    return addSymbol(&b->symbolTable, symbol);
+}
+
+/**
+ * Adds an AST_IDENT node referring to the declaration of the given symbol.
+ * */
+static int addIdentNode(AstBuilder* b, const Symbol* symbol, int* node)
+{
+    int err = addNode(b, AST_IDENT, node);
+    if(err) return err;
+
+    getAstNode(b->ast, *node)->value = symbol->address;
+
+    return 0;
+}
+
+/******************************************************************************/
+/* Definitions of helper functions ends ***************************************/
+/******************************************************************************/
+
+void initAst(Ast* ast, int capacity)
+{
+    ast->nodes = capacity > 0 ? (AstNode*)malloc((size_t)capacity * sizeof(AstNode)) : NULL;
+    ast->numberOfNodes = 0;
+    ast->capacity = ast->nodes ? capacity : 0;
+    ast->root = -1;
+    ast->overflowed = 0;
+}
+
+int newAstNode(Ast* ast, AstNodeKind kind)
+{
+    // Grow the allocated space geometrically if it is full
+    if(ast->numberOfNodes == ast->capacity)
+    {
+        int newCapacity = ast->capacity ? 2 * ast->capacity : 64;
+
+        AstNode* nodes = (AstNode*)realloc(ast->nodes, (size_t)newCapacity * sizeof(AstNode));
+
+        if(!nodes)
+        {
+            ast->overflowed = 1;
+            return -1;
+        }
+
+        ast->nodes = nodes;
+        ast->capacity = newCapacity;
+    }
+
+    ast->nodes[ast->numberOfNodes] = (AstNode){
+        .kind = kind, .op = 0, .level = 0, .value = 0,
+        .first = -1, .second = -1, .third = -1, .next = -1
+    };
+
+    return ast->numberOfNodes++;
+}
+
+AstNode* getAstNode(Ast* ast, int nodeInd)
+{
+    return &ast->nodes[nodeInd];
+}
+
+int buildAst(TokenList tokenList, Ast* ast)
+{
+    AstBuilder b;
+
+    b.tokenListIt = getTokenListIterator(&tokenList);
+    b.currentLevel = 0;
+    b.ast = ast;
+    b.numberOfVariables = 0;
+
+    initSymbolTable(&b.symbolTable);
+
+    int err = parseProgram(&b);
+
+    deleteSymbolTable(&b.symbolTable);
+
+    return err;
+}
+
+/**
+ * Calls visit with the given data and the AST_PROC node of every call in the
+ * .. given statement and the statements chained after it, in source order.
+ * */
+static void visitCalls(Ast* ast, int statement, void (*visit)(void* data, int proc), void* data)
+{
+    for(; statement >= 0; statement = getAstNode(ast, statement)->next)
+    {
+        const AstNode* n = getAstNode(ast, statement);
+
+        switch(n->kind)
+        {
+            case AST_CALL:
+                visit(data, n->value);
+                break;
+            case AST_BEGIN:
+                visitCalls(ast, n->first, visit, data);
+                break;
+            case AST_IF:
+                visitCalls(ast, n->second, visit, data);
+                visitCalls(ast, n->third, visit, data);
+                break;
+            case AST_WHILE:
+                visitCalls(ast, n->second, visit, data);
+                break;
+        }
+    }
+}
+
+/**
+ * Returns the statement of the block of the given AST_PROC node.
+ * */
+static int procedureStatement(Ast* ast, int proc)
+{
+    return getAstNode(ast, getAstNode(ast, proc)->first)->second;
+}
+
+/**
+ * The state of markCalledProcedures(): the procedures found so far, and the
+ * .. ones whose calls are yet to be visited.
+ * */
+typedef struct {
+    char* called;
+    int* stack;
+    int top;
+} CallMarker;
+
+static void markCall(void* data, int proc)
+{
+    CallMarker* marker = (CallMarker*)data;
+
+    if(!marker->called[proc])
+    {
+        marker->called[proc] = 1;
+        marker->stack[marker->top++] = proc;
+    }
+}
+
+int markCalledProcedures(Ast* ast, char* called)
+{
+    memset(called, 0, (size_t)ast->numberOfNodes);
+
+    if(ast->root < 0) return 0;
+
+    // Every procedure is pushed at most once
+    CallMarker marker;
+    marker.called = called;
+    marker.stack = (int*)malloc(((size_t)ast->numberOfNodes + 1) * sizeof(int));
+    marker.top = 0;
+
+    if(!marker.stack) return -1;
+
+    visitCalls(ast, getAstNode(ast, ast->root)->second, markCall, &marker);
+
+    while(marker.top)
+        visitCalls(ast, procedureStatement(ast, marker.stack[--marker.top]), markCall, &marker);
+
+    free(marker.stack);
+
+    return 0;
+}
+
+/**
+ * The call graph and the state of Tarjan's strongly connected components
+ * .. algorithm run on it by markRecursiveProcedures(). Arrays are indexed
+ * .. by AST_PROC node.
+ * */
+typedef struct {
+    char* recursive;
+
+    int* firstCallee;  // callees of a procedure are callees[firstCallee[p]..firstCallee[p + 1]-1]
+    int* callees;
+    int numberOfCalls;
+
+    int* index;        // the order a procedure is visited in, -1 if not yet
+    int* lowLink;      // the smallest index reachable through the visited tree
+    char* onStack;
+    int* stack;
+    int top;
+    int nextIndex;
+} CallGraph;
+
+static void countCall(void* data, int proc)
+{
+    (void)proc;
+    ((CallGraph*)data)->numberOfCalls++;
+}
+
+static void addCall(void* data, int proc)
+{
+    CallGraph* graph = (CallGraph*)data;
+
+    graph->callees[graph->numberOfCalls++] = proc;
+}
+
+static void findComponents(CallGraph* graph, int proc)
+{
+    graph->index[proc] = graph->lowLink[proc] = graph->nextIndex++;
+    graph->stack[graph->top++] = proc;
+    graph->onStack[proc] = 1;
+
+    for(int c = graph->firstCallee[proc]; c < graph->firstCallee[proc + 1]; c++)
+    {
+        int callee = graph->callees[c];
+
+        // A procedure calling itself is recursive on its own
+        if(callee == proc)
+            graph->recursive[proc] = 1;
+
+        if(graph->index[callee] < 0)
+        {
+            findComponents(graph, callee);
+            if(graph->lowLink[callee] < graph->lowLink[proc])
+                graph->lowLink[proc] = graph->lowLink[callee];
+        }
+        else if(graph->onStack[callee] && graph->index[callee] < graph->lowLink[proc])
+        {
+            graph->lowLink[proc] = graph->index[callee];
+        }
+    }
+
+    if(graph->lowLink[proc] != graph->index[proc])
+        return;
+
+    // proc is the root of a component. The procedures of a component with
+    // .. more than one procedure call each other.
+    int size = 0;
+    while(graph->stack[graph->top - 1 - size] != proc)
+        size++;
+    size++;
+
+    for(int i = 0; i < size; i++)
+    {
+        int member = graph->stack[--graph->top];
+
+        graph->onStack[member] = 0;
+        if(size > 1)
+            graph->recursive[member] = 1;
+    }
+}
+
+int markRecursiveProcedures(Ast* ast, char* recursive)
+{
+    int n = ast->numberOfNodes;
+    CallGraph graph;
+
+    memset(recursive, 0, (size_t)n);
+
+    graph.recursive = recursive;
+    graph.firstCallee = (int*)malloc(((size_t)n + 1) * sizeof(int));
+    graph.index = (int*)malloc((size_t)n * sizeof(int) + 1);
+    graph.lowLink = (int*)malloc((size_t)n * sizeof(int) + 1);
+    graph.onStack = (char*)calloc((size_t)n + 1, 1);
+    graph.stack = (int*)malloc((size_t)n * sizeof(int) + 1);
+    graph.callees = NULL;
+
+    int err = -1;
+
+    if(!graph.firstCallee || !graph.index || !graph.lowLink || !graph.onStack || !graph.stack)
+        goto cleanup;
+
+    // Count the calls of each procedure, then store them consecutively
+    graph.numberOfCalls = 0;
+    for(int p = 0; p < n; p++)
+    {
+        graph.firstCallee[p] = graph.numberOfCalls;
+        if(getAstNode(ast, p)->kind == AST_PROC)
+            visitCalls(ast, procedureStatement(ast, p), countCall, &graph);
+    }
+    graph.firstCallee[n] = graph.numberOfCalls;
+
+    graph.callees = (int*)malloc((size_t)graph.numberOfCalls * sizeof(int) + 1);
+    if(!graph.callees)
+        goto cleanup;
+
+    graph.numberOfCalls = 0;
+    for(int p = 0; p < n; p++)
+    {
+        if(getAstNode(ast, p)->kind == AST_PROC)
+            visitCalls(ast, procedureStatement(ast, p), addCall, &graph);
+    }
+
+    for(int p = 0; p < n; p++)
+        graph.index[p] = -1;
+
+    graph.top = 0;
+    graph.nextIndex = 0;
+
+    for(int p = 0; p < n; p++)
+    {
+        if(getAstNode(ast, p)->kind == AST_PROC && graph.index[p] < 0)
+            findComponents(&graph, p);
+    }
+
+    err = 0;
+
+cleanup:
+    free(graph.firstCallee);
+    free(graph.callees);
+    free(graph.index);
+    free(graph.lowLink);
+    free(graph.onStack);
+    free(graph.stack);
+
+    return err;
+}
+
+void deleteAst(Ast* ast)
+{
+    if(!ast) return;
+
+    free(ast->nodes);
+
+    initAst(ast, 0);
+}
+
+int parseProgram(AstBuilder* b)
+{
+    int err = parseBlock(b, &b->ast->root);
+    if(err) return err;
+
+    // After parsing block, periodsym should show up
+    if(currentTokenType(b) != periodsym)
+        return 6;
+
+    nextToken(b);
+
+    return 0;
+}
+
+int parseBlock(AstBuilder* b, int* node)
+{
+    int err, first = -1, last = -1, statement = -1;
+
+    // The variables of the enclosing block, if any, are numbered separately
+    int outerNumberOfVariables = b->numberOfVariables;
+    b->numberOfVariables = 0;
+
+    err = parseConstDeclaration(b, &first, &last);
+    if(!err)
+        err = parseVarDeclaration(b, &first, &last);
+    if(!err)
+        err = parseProcDeclaration(b, &first, &last);
+    if(!err)
+        err = parseStatement(b, &statement);
+    if(!err)
+        err = addNode(b, AST_BLOCK, node);
+
+    if(!err)
+    {
+        AstNode* block = getAstNode(b->ast, *node);
+
+        block->level = b->currentLevel;
+        block->value = b->numberOfVariables;
+        block->first = first;
+        block->second = statement;
+    }
+
+    b->numberOfVariables = outerNumberOfVariables;
+
+    return err;
+}
+
+int parseConstDeclaration(AstBuilder* b, int* first, int* last)
+{
+    int err, node;
+
+    if(currentTokenType(b) != constsym)
+        return 0;
+
+    do
+    {
+        // Consume constsym or commasym
+        nextToken(b);
+        if(currentTokenType(b) != identsym)
+            return 3;
+
+        err = addNode(b, AST_CONST, &node);
+        if(err) return err;
+
+        declare(b, CONST, node);
+        nextToken(b);
+
+        if(currentTokenType(b) != eqsym)
+            return 2;
+
+        nextToken(b);
+        if(currentTokenType(b) != numbersym)
+            return 1;
+
+        AstNode* constant = getAstNode(b->ast, node);
+        constant->level = b->currentLevel;
+        constant->value = atoi(currentToken(b).lexeme);
+
+        appendToList(b->ast, first, last, node);
+        nextToken(b);
+    }
+    while(currentTokenType(b) == commasym);
+
+    if(currentTokenType(b) != semicolonsym)
+        return 4;
+
+    nextToken(b);
+
+    return 0;
+}
+
+int parseVarDeclaration(AstBuilder* b, int* first, int* last)
+{
+    int err, node;
+
+    if(currentTokenType(b) != varsym)
+        return 0;
+
+    do
+    {
+        // Consume varsym or commasym
+        nextToken(b);
+        if(currentTokenType(b) != identsym)
+            return 3;
+
+        err = addNode(b, AST_VAR, &node);
+        if(err) return err;
+
+        AstNode* variable = getAstNode(b->ast, node);
+        variable->level = b->currentLevel;
+
+        // Variables follow the header of the activation record
+        variable->value = AR_VARIABLE_OFFSET + b->numberOfVariables;
+
+        declare(b, VAR, node);
+        nextToken(b);
+
+        // An initial value is accepted, but has no effect
+        if(currentTokenType(b) == eqsym)
+        {
+            nextToken(b);
+            if(currentTokenType(b) != numbersym)
+                return 1;
+
+            nextToken(b);
+        }
+
+        if(currentTokenType(b) != commasym && currentTokenType(b) != semicolonsym)
+            return 4;
+
+        b->numberOfVariables++;
+        appendToList(b->ast, first, last, node);
+    }
+    while(currentTokenType(b) == commasym);
+
+    nextToken(b);
+
+    return 0;
+}
+
+int parseProcDeclaration(AstBuilder* b, int* first, int* last)
+{
+    int err, node, block;
+
+    while(currentTokenType(b) == procsym)
+    {
+        nextToken(b);
+        if(currentTokenType(b) != identsym)
+            return 3;
+
+        err = addNode(b, AST_PROC, &node);
+        if(err) return err;
+
+        getAstNode(b->ast, node)->level = b->currentLevel;
+        getAstNode(b->ast, node)->value = b->tokenListIt.currentTokenInd;
+        appendToList(b->ast, first, last, node);
+
+        Symbol* procSymbol = declare(b, PROC, node);
+        nextToken(b);
+
+        if(currentTokenType(b) != semicolonsym)
+            return 5;
+
+        nextToken(b);
+
+        // The procedure's own declarations are visible only in its block
+        pushScope(&b->symbolTable, procSymbol);
+        b->currentLevel++;
+        err = parseBlock(b, &block);
+        b->currentLevel--;
+        popScope(&b->symbolTable);
+
+        if(err)
+            return err;
+
+        getAstNode(b->ast, node)->first = block;
+
+        if(currentTokenType(b) != semicolonsym)
+            return 5;
+
+        nextToken(b);
+    }
+
+    return 0;
+}
+
+int parseStatement(AstBuilder* b, int* node)
+{
+    int err, first, last, statement;
+    Symbol* symbol;
+
+    *node = -1;
+
+    switch(currentTokenType(b))
+    {
+    case identsym:
+        symbol = findSymbol(&b->symbolTable, currentToken(b).lexeme);
+        if(symbol == NULL)
+            return 15;
+        if(symbol->type != VAR)
+            return 16;
+
+        nextToken(b);
+        if(currentTokenType(b) != becomessym)
+            return 7;
+
+        nextToken(b);
+        err = parseExpression(b, &first);
+        if(err) return err;
+
+        err = addNode(b, AST_ASSIGN, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->value = symbol->address;
+        getAstNode(b->ast, *node)->first = first;
+
+        return 0;
+
+    case callsym:
+        nextToken(b);
+        if(currentTokenType(b) != identsym)
+            return 8;
+
+        symbol = findSymbol(&b->symbolTable, currentToken(b).lexeme);
+        if(symbol == NULL)
+            return 15;
+        if(symbol->type != PROC)
+            return 17;
+
+        nextToken(b);
+
+        err = addNode(b, AST_CALL, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->value = symbol->address;
+
+        return 0;
+
+    case beginsym:
+        first = last = -1;
+
+        do
+        {
+            // Consume beginsym or semicolonsym
+            nextToken(b);
+            err = parseStatement(b, &statement);
+            if(err) return err;
+
+            // Empty statements are left out
+            if(statement >= 0)
+                appendToList(b->ast, &first, &last, statement);
+        }
+        while(currentTokenType(b) == semicolonsym);
+
+        if(currentTokenType(b) != endsym)
+            return 10;
+
+        nextToken(b);
+
+        err = addNode(b, AST_BEGIN, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->first = first;
+
+        return 0;
+
+    case ifsym:
+        err = addNode(b, AST_IF, node);
+        if(err) return err;
+
+        nextToken(b);
+        err = parseCondition(b, &first);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->first = first;
+
+        if(currentTokenType(b) != thensym)
+            return 9;
+
+        nextToken(b);
+        err = parseStatement(b, &statement);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->second = statement;
+
+        if(currentTokenType(b) == elsesym)
+        {
+            nextToken(b);
+            err = parseStatement(b, &statement);
+            if(err) return err;
+
+            getAstNode(b->ast, *node)->third = statement;
+        }
+
+        return 0;
+
+    case whilesym:
+        err = addNode(b, AST_WHILE, node);
+        if(err) return err;
+
+        nextToken(b);
+        err = parseCondition(b, &first);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->first = first;
+
+        if(currentTokenType(b) != dosym)
+            return 11;
+
+        nextToken(b);
+        err = parseStatement(b, &statement);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->second = statement;
+
+        return 0;
+
+    case writesym:
+        nextToken(b);
+        if(currentTokenType(b) != identsym)
+            return 3;
+
+        symbol = findSymbol(&b->symbolTable, currentToken(b).lexeme);
+        if(symbol == NULL)
+            return 15;
+        if(symbol->type == PROC)
+            return 18;
+
+        nextToken(b);
+
+        err = addIdentNode(b, symbol, &first);
+        if(!err)
+            err = addNode(b, AST_WRITE, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->first = first;
+
+        return 0;
+
+    case readsym:
+        nextToken(b);
+        if(currentTokenType(b) != identsym)
+            return 3;
+
+        symbol = findSymbol(&b->symbolTable, currentToken(b).lexeme);
+        if(symbol == NULL)
+            return 15;
+        if(symbol->type != VAR)
+            return 19;
+
+        nextToken(b);
+
+        err = addNode(b, AST_READ, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->value = symbol->address;
+
+        return 0;
+    }
+
+    // Empty statement
+    return 0;
+}
+
+int parseCondition(AstBuilder* b, int* node)
+{
+    int err, left, right, op;
+
+    if(currentTokenType(b) == oddsym)
+    {
+        nextToken(b);
+        err = parseExpression(b, &left);
+        if(err) return err;
+
+        err = addNode(b, AST_UNARY, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->op = ODD;
+        getAstNode(b->ast, *node)->first = left;
+
+        return 0;
+    }
+
+    err = parseExpression(b, &left);
+    if(err) return err;
+
+    switch(currentTokenType(b))
+    {
+        case eqsym:  op = EQL; break;
+        case neqsym: op = NEQ; break;
+        case lessym: op = LSS; break;
+        case leqsym: op = LEQ; break;
+        case gtrsym: op = GTR; break;
+        case geqsym: op = GEQ; break;
+        default:
+            return 12;
+    }
+
+    nextToken(b);
+    err = parseExpression(b, &right);
+    if(err) return err;
+
+    err = addNode(b, AST_BINARY, node);
+    if(err) return err;
+
+    AstNode* condition = getAstNode(b->ast, *node);
+    condition->op = op;
+    condition->first = left;
+    condition->second = right;
+
+    return 0;
+}
+
+int parseExpression(AstBuilder* b, int* node)
+{
+    int err, left, right;
+    int op = currentTokenType(b);
+
+    if(op == plussym || op == minussym)
+        nextToken(b);
+
+    err = parseTerm(b, node);
+    if(err) return err;
+
+    if(op == minussym)
+    {
+        left = *node;
+
+        err = addNode(b, AST_UNARY, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->op = NEG;
+        getAstNode(b->ast, *node)->first = left;
+    }
+
+    op = currentTokenType(b);
+    while(op == plussym || op == minussym)
+    {
+        nextToken(b);
+        err = parseTerm(b, &right);
+        if(err) return err;
+
+        left = *node;
+
+        err = addNode(b, AST_BINARY, node);
+        if(err) return err;
+
+        AstNode* binary = getAstNode(b->ast, *node);
+        binary->op = op == plussym ? ADD : SUB;
+        binary->first = left;
+        binary->second = right;
+
+        op = currentTokenType(b);
+    }
+
+    return 0;
+}
+
+int parseTerm(AstBuilder* b, int* node)
+{
+    int err, left, right, op;
+
+    err = parseFactor(b, node);
+    if(err) return err;
+
+    op = currentTokenType(b);
+    while(op == multsym || op == slashsym)
+    {
+        nextToken(b);
+        err = parseFactor(b, &right);
+        if(err) return err;
+
+        left = *node;
+
+        err = addNode(b, AST_BINARY, node);
+        if(err) return err;
+
+        AstNode* binary = getAstNode(b->ast, *node);
+        binary->op = op == multsym ? MUL : DIV;
+        binary->first = left;
+        binary->second = right;
+
+        op = currentTokenType(b);
+    }
+
+    return 0;
+}
+
+int parseFactor(AstBuilder* b, int* node)
+{
+    int err;
+
+    switch(currentTokenType(b))
+    {
+    case identsym:
+    {
+        Symbol* symbol = findSymbol(&b->symbolTable, currentToken(b).lexeme);
+        if(symbol == NULL)
+            return 15;
+        if(symbol->type == PROC)
+            return 14;
+
+        nextToken(b);
+
+        return addIdentNode(b, symbol, node);
+    }
+
+    case numbersym:
+        err = addNode(b, AST_NUMBER, node);
+        if(err) return err;
+
+        getAstNode(b->ast, *node)->value = atoi(currentToken(b).lexeme);
+        nextToken(b);
+
+        return 0;
+
+    case lparentsym:
+        nextToken(b);
+        err = parseExpression(b, node);
+        if(err) return err;
+
+        if(currentTokenType(b) != rparentsym)
+            return 13;
+
+        nextToken(b);
+
+        return 0;
+    }
+
+    return 14;
+}
@@ -0,0 +1,138 @@
+#ifndef __AST_H__
+#define __AST_H__
+
+#include <stdint.h>
+#include "token.h"
+
+/**
+ * The kinds of the nodes of the abstract syntax tree.
+ * */
+typedef enum {
+    AST_BLOCK,
+
+    // Declarations
+    AST_CONST,
+    AST_VAR,
+    AST_PROC,
+
+    // Statements
+    AST_ASSIGN,
+    AST_CALL,
+    AST_BEGIN,
+    AST_IF,
+    AST_WHILE,
+    AST_READ,
+    AST_WRITE,
+
+    // Expressions
+    AST_NUMBER,
+    AST_IDENT,
+    AST_UNARY,
+    AST_BINARY
+} AstNodeKind;
+
+/**
+ * A node of the abstract syntax tree. Nodes refer to each other by their
+ * .. index in the tree, -1 standing for no node. Lists, such as the
+ * .. declarations of a block or the statements of a begin, are chained through
+ * .. the next field, starting from the first field of their parent.
+ * The validity of fields are as follows:
+ * AST_BLOCK : level, value (the number of variables), first (declarations),
+ *             second (statement, -1 if empty)
+ * AST_CONST : level, value
+ * AST_VAR   : level, value (the address of the variable in the activation record)
+ * AST_PROC  : level, value (the index of its name in the token list), first (block)
+ * AST_ASSIGN: value (the variable), first (expression)
+ * AST_CALL  : value (the procedure)
+ * AST_BEGIN : first (statements, empty statements are left out)
+ * AST_IF    : first (condition), second (then, -1 if empty), third (else, -1 if none or empty)
+ * AST_WHILE : first (condition), second (body, -1 if empty)
+ * AST_READ  : value (the variable)
+ * AST_WRITE : first (an AST_IDENT expression)
+ * AST_NUMBER: value
+ * AST_IDENT : value (the constant or the variable)
+ * AST_UNARY : op (NEG or ODD), first (operand)
+ * AST_BINARY: op (one of ADD..DIV, EQL..GEQ), first (left), second (right)
+ * Identifiers are resolved while parsing, so nodes using a name hold the index
+ * .. of its declaration node in value. The level of a declaration is the
+ * .. nesting level of the block it is declared in, 0 being the main block.
+ * The next field is valid on every node, -1 if the node is not in a list or
+ * .. is the last one.
+ * */
+typedef struct {
+    uint8_t kind; // AstNodeKind
+    uint8_t op;   // opcode
+    int32_t level;
+    int32_t value;
+    int32_t first;
+    int32_t second;
+    int32_t third;
+    int32_t next;
+} AstNode;
+
+/**
+ * Abstract syntax tree.
+ * All the nodes are allocated from a single array, which grows geometrically
+ * .. and is freed at once, so the tree takes space linear in the size of the
+ * .. program and its nodes are laid out in the order they were parsed.
+ * */
+typedef struct {
+    AstNode* nodes;
+    int numberOfNodes;
+    int capacity;
+    int root;       // the AST_BLOCK of the main block, -1 if none
+    int overflowed; // set once a node could not be allocated
+} Ast;
+
+/**
+ * Initializes the given Ast to an empty tree with room for the given number
+ * .. of nodes.
+ * */
+void initAst(Ast*, int capacity);
+
+/**
+ * Appends a node of the given kind, with all the other fields set to 0 or -1,
+ * .. and returns its index. If the allocation fails, sets the overflowed flag
+ * .. and returns -1.
+ * Appending a node can move the nodes, so pointers to nodes must not be held
+ * .. across calls.
+ * */
+int newAstNode(Ast*, AstNodeKind kind);
+
+/**
+ * Returns the node at the given index.
+ * */
+AstNode* getAstNode(Ast*, int nodeInd);
+
+/**
+ * Parses the program in the given token list into the given Ast, resolving
+ * .. the identifiers through a symbol table. Returns 0 on success. Otherwise,
+ * .. returns the code generator error code of the first error found; errors
+ * .. are reported in the order of the tokens. If the tree could not be
+ * .. allocated, returns 20.
+ * The Ast should be deleted with deleteAst() in either case.
+ * */
+int buildAst(TokenList, Ast*);
+
+/**
+ * Walks the call graph from the main block and sets called[node] for every
+ * .. AST_PROC node that is called from it, directly or through other
+ * .. procedures. called needs room for numberOfNodes entries.
+ * Returns 0 on success, -1 if the temporary space could not be allocated.
+ * */
+int markCalledProcedures(Ast*, char* called);
+
+/**
+ * Sets recursive[node] for every AST_PROC node that can call itself, directly
+ * .. or through other procedures. recursive needs room for numberOfNodes
+ * .. entries.
+ * Returns 0 on success, -1 if the temporary space could not be allocated.
+ * */
+int markRecursiveProcedures(Ast*, char* recursive);
+
+/**
+ * Makes the necessary deallocations on the Ast and resets it to empty.
+ * */
+void deleteAst(Ast*);
+
+#endif
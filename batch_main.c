@@ -0,0 +1,646 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "token.h"
+#include "source_code.h"
+#include "lexical_analyzer.h"
+#include "code_generator.h"
+#include "peephole.h"
+#include "thread_pool.h"
+#include "vm/vm.h"
+
+/**
+ * One entry of the manifest, in the format of test/tests.txt:
+ *  not_error (input) (cg_out) (vm_inp) (vm_out) (expected_vm_out)
+ *  error     (input) (cg_out) (expected_cg_out)
+ * The input is a lexer out, or PL/0 source code with --source.
+ * */
+typedef struct {
+    int isError; // whether compilation is expected to fail
+    const char* input;
+    const char* cgOut;
+    const char* vmInp;
+    const char* vmOut;
+    const char* expected; // the expected vm_out, or cg_out for an error case
+} BatchJob;
+
+typedef enum {
+    JOB_PASSED,
+    JOB_FAILED,
+    JOB_OUT_OF_BUDGET
+} JobStatus;
+
+typedef struct {
+    JobStatus status;
+    const char* reason; // why the job failed
+    char* faults;       // what the VM reported, NULL if nothing
+    double seconds;
+} JobResult;
+
+/**
+ * The shared state of the batch. Jobs only read it, apart from each writing
+ * .. its own result.
+ * */
+typedef struct {
+    BatchJob* jobs;
+    JobResult* results;
+    int numberOfJobs;
+    int fromSource;
+    CodeGenOptions cgOptions;
+    VMOptions vmOptions;
+} Batch;
+
+/**
+ * Returns the number of seconds elapsed since the given time.
+ * */
+static double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)(now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Reads the whole file at the given path. Returns a SourceCode whose text is
+ * .. NULL if the file could not be opened or is empty.
+ * */
+static SourceCode readWholeFile(const char* path)
+{
+    FILE* fp = fopen(path, "r");
+    SourceCode file = readSourceCode(fp);
+
+    if(fp) fclose(fp);
+
+    return file;
+}
+
+/**
+ * Advances the given cursor past the next line that is not blank, and sets
+ * .. line and lineEnd to its bounds. Returns 0 if there are no lines left.
+ * */
+static int nextNonBlankLine(const char** cursor, const char* end, const char** line, const char** lineEnd)
+{
+    while(*cursor < end)
+    {
+        *line = *cursor;
+        *lineEnd = memchr(*cursor, '\n', (size_t)(end - *cursor));
+        if(!*lineEnd) *lineEnd = end;
+
+        *cursor = *lineEnd < end ? *lineEnd + 1 : end;
+
+        for(const char* c = *line; c < *lineEnd; c++)
+        {
+            if(!isspace((unsigned char)*c)) return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Returns whether the two lines are equal when all the whitespace is ignored.
+ * */
+static int sameLine(const char* a, const char* aEnd, const char* b, const char* bEnd)
+{
+    for(;;)
+    {
+        while(a < aEnd && isspace((unsigned char)*a)) a++;
+        while(b < bEnd && isspace((unsigned char)*b)) b++;
+
+        if(a == aEnd || b == bEnd) return a == aEnd && b == bEnd;
+        if(*a++ != *b++) return 0;
+    }
+}
+
+/**
+ * Returns whether the files at the given paths have the same contents, as
+ * .. `diff -B -w` compares them: blank lines and whitespace are ignored. A
+ * .. missing file is compared as an empty one.
+ * */
+static int sameOutput(const char* path, const char* expectedPath)
+{
+    SourceCode a = readWholeFile(path);
+    SourceCode b = readWholeFile(expectedPath);
+
+    const char *aCursor = a.text, *aEnd = a.text + a.length;
+    const char *bCursor = b.text, *bEnd = b.text + b.length;
+    const char *aLine, *aLineEnd, *bLine, *bLineEnd;
+
+    int same = 1;
+
+    for(;;)
+    {
+        int aHasLine = a.text && nextNonBlankLine(&aCursor, aEnd, &aLine, &aLineEnd);
+        int bHasLine = b.text && nextNonBlankLine(&bCursor, bEnd, &bLine, &bLineEnd);
+
+        if(!aHasLine || !bHasLine)
+        {
+            same = !aHasLine && !bHasLine;
+            break;
+        }
+
+        if(!sameLine(aLine, aLineEnd, bLine, bLineEnd))
+        {
+            same = 0;
+            break;
+        }
+    }
+
+    deleteSourceCode(&a);
+    deleteSourceCode(&b);
+
+    return same;
+}
+
+/**
+ * Creates the directories on the given path to a file, as `mkdir -p` does.
+ * */
+static void makeParentDirectories(const char* path)
+{
+    char* directory = (char*)malloc(strlen(path) + 1);
+
+    if(!directory) return;
+
+    strcpy(directory, path);
+
+    for(char* c = directory + 1; *c; c++)
+    {
+        if(*c != '/') continue;
+
+        *c = '\0';
+        if(mkdir(directory, 0777) && errno != EEXIST) break;
+        *c = '/';
+    }
+
+    free(directory);
+}
+
+/**
+ * Compiles the input of the given job into the given CodeBuffer and writes
+ * .. either the code or the error to the cg_out of the job, as
+ * .. code_generator.out does. Returns 0 if the code was generated, 1 if the
+ * .. input has an error, -1 if a file could not be opened.
+ * */
+static int compileJob(const Batch* batch, const BatchJob* job, CodeBuffer* code)
+{
+    FILE* inp = fopen(job->input, "r");
+    FILE* cgOutp = fopen(job->cgOut, "w");
+
+    int result = -1;
+
+    if(!inp || !cgOutp)
+        goto cleanup;
+
+    TokenList tokenList;
+    SourceCode sourceCode = { NULL, 0, NULL, 0 };
+    LexerOut lexerOut;
+
+    if(batch->fromSource)
+    {
+        sourceCode = readSourceCode(inp);
+        lexerOut = lexicalAnalyzer(sourceCode);
+
+        if(lexerOut.lexerError != NONE)
+        {
+            printLexErr(lexerOut.lexerError, lexerOut.errorLine, cgOutp);
+            result = 1;
+        }
+
+        tokenList = lexerOut.tokenList;
+    }
+    else
+    {
+        tokenList = readTokenList(inp);
+    }
+
+    if(result != 1)
+    {
+        int err = compileTokenList(tokenList, batch->cgOptions, code);
+
+        if(err)
+        {
+            printCGErr(err, cgOutp);
+            result = 1;
+        }
+        else
+        {
+            printCodeBuffer(code, cgOutp);
+            result = 0;
+        }
+    }
+
+    if(batch->fromSource)
+    {
+        deleteLexerOut(&lexerOut);
+        deleteSourceCode(&sourceCode);
+    }
+    else
+    {
+        deleteTokenList(&tokenList);
+    }
+
+cleanup:
+    if(inp) fclose(inp);
+    if(cgOutp) fclose(cgOutp);
+
+    return result;
+}
+
+/**
+ * Runs the given job, filling its result except for the time. Only the files
+ * .. of the job and its own result are touched, so jobs can run concurrently.
+ * */
+static void runJob(const Batch* batch, const BatchJob* job, JobResult* result)
+{
+    CodeBuffer code;
+    int compiled = compileJob(batch, job, &code);
+
+    result->status = JOB_FAILED;
+
+    if(compiled < 0)
+    {
+        result->reason = "could not open the input or the cg_out";
+        return;
+    }
+
+    if(job->isError)
+    {
+        if(compiled == 0) deleteCodeBuffer(&code);
+
+        if(sameOutput(job->cgOut, job->expected))
+            result->status = JOB_PASSED;
+        else
+            result->reason = "cg_out differs from the expected error";
+
+        return;
+    }
+
+    if(compiled == 1)
+    {
+        result->reason = "compilation failed";
+        return;
+    }
+
+    FILE* vmInp = fopen(job->vmInp, "r");
+    FILE* vmOutp = fopen(job->vmOut, "w");
+
+    // The faults of the program are kept with its result
+    char* faults = NULL;
+    size_t faultsLength = 0;
+    FILE* faultOutp = open_memstream(&faults, &faultsLength);
+
+    if(vmInp && vmOutp && faultOutp)
+    {
+        VMOptions vmOptions = batch->vmOptions;
+        vmOptions.faultOutp = faultOutp;
+
+        int vmResult = runProgram(code.instructions, code.numberOfInstructions, NULL, vmInp, vmOutp, vmOptions);
+
+        fclose(vmOutp);
+        vmOutp = NULL;
+
+        // A fault is only a failure if the output differs: a case may expect
+        // .. the program to fault
+        if(vmResult == -2)
+        {
+            result->status = JOB_OUT_OF_BUDGET;
+            result->reason = "the program went over its budget";
+        }
+        else if(sameOutput(job->vmOut, job->expected))
+        {
+            result->status = JOB_PASSED;
+        }
+        else
+        {
+            result->reason = "vm_out differs from the expected output";
+        }
+    }
+    else
+    {
+        result->reason = "could not open the vm_inp or the vm_out";
+    }
+
+    if(vmInp) fclose(vmInp);
+    if(vmOutp) fclose(vmOutp);
+
+    if(faultOutp)
+    {
+        fclose(faultOutp);
+
+        if(faultsLength) result->faults = faults;
+        else             free(faults);
+    }
+
+    deleteCodeBuffer(&code);
+}
+
+/**
+ * The task of the thread pool: runs the job at the given index and times it.
+ * */
+static void runBatchTask(void* context, int index)
+{
+    Batch* batch = (Batch*)context;
+    JobResult* result = &batch->results[index];
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    runJob(batch, &batch->jobs[index], result);
+
+    result->seconds = secondsSince(&start);
+}
+
+/**
+ * Returns the next whitespace separated field of the null-terminated line at
+ * .. the cursor, terminating it in place, or NULL if there are no fields left.
+ * */
+static char* nextField(char** cursor)
+{
+    char* c = *cursor;
+
+    while(isspace((unsigned char)*c)) c++;
+
+    if(*c == '\0')
+    {
+        *cursor = c;
+        return NULL;
+    }
+
+    char* field = c;
+
+    while(*c && !isspace((unsigned char)*c)) c++;
+
+    if(*c) *c++ = '\0';
+    *cursor = c;
+
+    return field;
+}
+
+/**
+ * Parses the manifest held in the given buffer, which is modified to hold
+ * .. the fields of the jobs. Returns the number of jobs, -1 if a line is
+ * .. malformed, in which case its number is set.
+ * */
+static int parseManifest(char* manifest, BatchJob* jobs, int* badLine)
+{
+    int numberOfJobs = 0;
+    int lineNumber = 0;
+
+    char* line = manifest;
+
+    while(*line)
+    {
+        char* lineEnd = strchr(line, '\n');
+        char* next = lineEnd ? lineEnd + 1 : line + strlen(line);
+
+        if(lineEnd) *lineEnd = '\0';
+        lineNumber++;
+
+        char* cursor = line;
+        char* fields[6];
+        int numberOfFields = 0;
+
+        while(numberOfFields < 6 && (fields[numberOfFields] = nextField(&cursor)) != NULL)
+            numberOfFields++;
+
+        line = next;
+
+        // Blank lines are skipped
+        if(numberOfFields == 0) continue;
+
+        BatchJob* job = &jobs[numberOfJobs];
+
+        if(numberOfFields == 6 && !strcmp(fields[0], "not_error"))
+        {
+            *job = (BatchJob){ 0, fields[1], fields[2], fields[3], fields[4], fields[5] };
+        }
+        else if(numberOfFields == 4 && !strcmp(fields[0], "error"))
+        {
+            *job = (BatchJob){ 1, fields[1], fields[2], NULL, NULL, fields[3] };
+        }
+        else
+        {
+            *badLine = lineNumber;
+            return -1;
+        }
+
+        numberOfJobs++;
+    }
+
+    return numberOfJobs;
+}
+
+int main(int argc, char **argv)
+{
+    Batch batch;
+
+    batch.fromSource = 0;
+    batch.cgOptions = getDefaultCodeGenOptions();
+    batch.vmOptions = getDefaultVMOptions();
+    batch.vmOptions.trace = VM_TRACE_OFF;
+    batch.vmOptions.timeLimit = 1;
+
+    int numberOfThreads = getNumberOfProcessors();
+
+    /**********************************/
+    /* Parse Command Line Arguments */
+    /**********************************/
+    // Options come before the manifest
+    while(argc > 2)
+    {
+        if(!strcmp(argv[1], "--source"))
+        {
+            batch.fromSource = 1;
+        }
+        else if(!strcmp(argv[1], "--jobs") && argc > 3 && atoi(argv[2]) > 0)
+        {
+            numberOfThreads = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--max-steps") && argc > 3 && atoll(argv[2]) >= 0)
+        {
+            batch.vmOptions.maxSteps = atoll(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--time-limit") && argc > 3 && atof(argv[2]) >= 0)
+        {
+            batch.vmOptions.timeLimit = atof(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--no-fusion"))
+        {
+            batch.vmOptions.fuseInstructions = 0;
+        }
+        else if(!strcmp(argv[1], "--no-peephole"))
+        {
+            batch.cgOptions.peepholePasses = PEEPHOLE_NONE;
+        }
+        else if(!strcmp(argv[1], "--no-dead-code-elimination"))
+        {
+            batch.cgOptions.eliminateDeadCode = 0;
+        }
+        else if(!strcmp(argv[1], "--inline-threshold") && argc > 3 && atoi(argv[2]) >= 0)
+        {
+            batch.cgOptions.inlineThreshold = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--max-code-length") && argc > 3 && atoi(argv[2]) > 0)
+        {
+            batch.cgOptions.maxCodeLength = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else
+        {
+            break;
+        }
+
+        argc--;
+        argv++;
+    }
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "Usage: ./pl0_batch [--jobs n] [--source] [--max-steps n] [--time-limit s] [--no-fusion] [--max-code-length n] [--no-peephole] [--no-dead-code-elimination] [--inline-threshold n] (manifest)\n");
+
+        fprintf(stderr, "\n       Compiles and runs every case of the manifest in a single process, on a pool of threads, and grades the outputs.\n");
+
+        fprintf(stderr, "\n       --jobs: The number of threads. Defaults to the number of processors, %d.\n", numberOfThreads);
+
+        fprintf(stderr, "\n       --source: The input of every case is PL/0 source code instead of a lexer out.\n");
+
+        fprintf(stderr, "\n       --max-steps: The most instructions a program may execute. 0, the default, means no limit.\n");
+
+        fprintf(stderr, "\n       --time-limit: The most seconds a program may run. 0 means no limit. Defaults to %g.\n", batch.vmOptions.timeLimit);
+
+        fprintf(stderr, "\n       --no-fusion: Execute common instruction sequences one instruction at a time instead of as superinstructions.\n");
+
+        fprintf(stderr, "\n       --max-code-length, --no-peephole, --no-dead-code-elimination, --inline-threshold: The code generator options, as for code_generator.out.\n");
+
+        fprintf(stderr, "\n       manifest: The list of cases, one per line, in the format of test/tests.txt. The paths are relative to the working directory.\n");
+        return -1;
+    }
+
+    // Read and parse the manifest, which holds the paths of the jobs
+    FILE* manifestFile = fopen(argv[1], "r");
+
+    if(!manifestFile)
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[1]);
+        return -1;
+    }
+
+    SourceCode manifestText = readSourceCode(manifestFile);
+    fclose(manifestFile);
+
+    // Every line holds at most one job
+    int maxJobs = 1;
+    char* manifest = (char*)malloc(manifestText.length + 1);
+
+    if(manifest)
+    {
+        memcpy(manifest, manifestText.text ? manifestText.text : "", manifestText.length);
+        manifest[manifestText.length] = '\0';
+
+        for(size_t i = 0; i < manifestText.length; i++)
+            maxJobs += manifest[i] == '\n';
+    }
+
+    deleteSourceCode(&manifestText);
+
+    batch.jobs = (BatchJob*)malloc((size_t)maxJobs * sizeof(BatchJob));
+    batch.results = (JobResult*)calloc((size_t)maxJobs, sizeof(JobResult));
+
+    int result = -1;
+
+    if(!manifest || !batch.jobs || !batch.results)
+    {
+        fprintf(stderr, "Could not allocate space for the jobs.\n");
+        goto cleanup;
+    }
+
+    int badLine = 0;
+    batch.numberOfJobs = parseManifest(manifest, batch.jobs, &badLine);
+
+    if(batch.numberOfJobs < 0)
+    {
+        fprintf(stderr, "Line %d of \"%s\" is not a valid case.\n", badLine, argv[1]);
+        goto cleanup;
+    }
+
+    // The directories are created up front, so that the jobs do not race to
+    // .. create them
+    for(int i = 0; i < batch.numberOfJobs; i++)
+    {
+        makeParentDirectories(batch.jobs[i].cgOut);
+        if(!batch.jobs[i].isError) makeParentDirectories(batch.jobs[i].vmOut);
+    }
+
+    /**********************************/
+    /******** Run the batch ***********/
+    /**********************************/
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    runTasks(batch.numberOfJobs, numberOfThreads, runBatchTask, &batch);
+
+    double wallSeconds = secondsSince(&start);
+
+    /**********************************/
+    /******** Report the results ******/
+    /**********************************/
+    int passed = 0, outOfBudget = 0;
+    double jobSeconds = 0;
+
+    for(int i = 0; i < batch.numberOfJobs; i++)
+    {
+        const JobResult* jobResult = &batch.results[i];
+
+        jobSeconds += jobResult->seconds;
+
+        if(jobResult->status == JOB_PASSED)
+        {
+            passed++;
+            printf("TEST[%d] PASSED (%.3f ms)\n", i, jobResult->seconds * 1e3);
+            continue;
+        }
+
+        if(jobResult->status == JOB_OUT_OF_BUDGET) outOfBudget++;
+
+        printf("TEST[%d] FAILED (%.3f ms): %s\n", i, jobResult->seconds * 1e3, jobResult->reason);
+        printf("  input: %s\n", batch.jobs[i].input);
+        if(jobResult->faults) printf("%s", jobResult->faults);
+    }
+
+    printf("# of tests       : %d\n", batch.numberOfJobs);
+    printf("# of tests passed: %d\n", passed);
+    printf("# of tests failed: %d\n", batch.numberOfJobs - passed);
+    printf("# over budget    : %d\n", outOfBudget);
+    printf("threads          : %d\n", numberOfThreads < batch.numberOfJobs ? numberOfThreads : batch.numberOfJobs);
+    printf("wall time        : %.3f s (%.3f s of jobs)\n", wallSeconds, jobSeconds);
+
+    result = passed == batch.numberOfJobs ? 0 : -1;
+
+cleanup:
+    if(batch.results)
+    {
+        for(int i = 0; i < maxJobs; i++)
+            free(batch.results[i].faults);
+    }
+
+    free(batch.jobs);
+    free(batch.results);
+    free(manifest);
+
+    return result;
+}
@@ -0,0 +1,182 @@
+#include "cfg.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Returns whether the given code address is the address of an instruction.
+ * */
+static int isInstructionIndex(const CodeBuffer* code, int index)
+{
+    return index >= 0 && index < code->numberOfInstructions;
+}
+
+int buildControlFlowGraph(const CodeBuffer* code, ControlFlowGraph* cfg)
+{
+    int n = code->numberOfInstructions;
+
+    cfg->blocks = NULL;
+    cfg->numberOfBlocks = 0;
+    cfg->blockOf = (int*)malloc(((size_t)n + 1) * sizeof(int));
+
+    if(!cfg->blockOf) return -1;
+
+    // Find the leaders: the entry, jump targets and the instructions that
+    // .. follow a jump or a return. blockOf temporarily marks them.
+    memset(cfg->blockOf, 0, ((size_t)n + 1) * sizeof(int));
+    cfg->blockOf[0] = 1;
+
+    for(int i = 0; i < n; i++)
+    {
+        const Instruction* ins = &code->instructions[i];
+
+        switch(ins->op)
+        {
+            case JMP: case JPC: case CAL:
+                if(isInstructionIndex(code, ins->m))
+                    cfg->blockOf[ins->m] = 1;
+                cfg->blockOf[i + 1] = 1;
+                break;
+            case RTN: case SIO_HALT:
+                cfg->blockOf[i + 1] = 1;
+                break;
+        }
+    }
+
+    int numberOfBlocks = 0;
+    for(int i = 0; i < n; i++)
+        numberOfBlocks += cfg->blockOf[i];
+
+    cfg->blocks = (BasicBlock*)malloc(((size_t)numberOfBlocks + 1) * sizeof(BasicBlock));
+
+    if(!cfg->blocks)
+    {
+        deleteControlFlowGraph(cfg);
+        return -1;
+    }
+
+    // Number the blocks
+    for(int i = 0; i < n; i++)
+    {
+        if(cfg->blockOf[i])
+        {
+            BasicBlock* block = &cfg->blocks[cfg->numberOfBlocks++];
+            block->start = i;
+            block->successors[0] = block->successors[1] = -1;
+        }
+
+        cfg->blockOf[i] = cfg->numberOfBlocks - 1;
+        cfg->blocks[cfg->numberOfBlocks - 1].end = i + 1;
+    }
+
+    // Connect each block to its successors, given by its last instruction
+    for(int b = 0; b < cfg->numberOfBlocks; b++)
+    {
+        BasicBlock* block = &cfg->blocks[b];
+        const Instruction* last = &code->instructions[block->end - 1];
+
+        int target = isInstructionIndex(code, last->m) ? cfg->blockOf[last->m] : -1;
+        int next = block->end < n ? cfg->blockOf[block->end] : -1;
+
+        switch(last->op)
+        {
+            case JMP:
+                block->successors[0] = target;
+                break;
+            case JPC: case CAL:
+                block->successors[0] = target;
+                block->successors[1] = next;
+                break;
+            case RTN: case SIO_HALT:
+                break;
+            default:
+                block->successors[0] = next;
+                break;
+        }
+    }
+
+    return 0;
+}
+
+void markReachableBlocks(const ControlFlowGraph* cfg, char* reachable)
+{
+    memset(reachable, 0, (size_t)cfg->numberOfBlocks);
+
+    if(!cfg->numberOfBlocks) return;
+
+    // Depth-first search from the entry, with an explicit stack: every block
+    // .. is pushed at most once
+    int* stack = (int*)malloc((size_t)cfg->numberOfBlocks * sizeof(int));
+    int top = 0;
+
+    if(!stack)
+    {
+        // Without the search, every block is kept
+        memset(reachable, 1, (size_t)cfg->numberOfBlocks);
+        return;
+    }
+
+    reachable[0] = 1;
+    stack[top++] = 0;
+
+    while(top)
+    {
+        const BasicBlock* block = &cfg->blocks[stack[--top]];
+
+        for(int s = 0; s < 2; s++)
+        {
+            int successor = block->successors[s];
+
+            if(successor >= 0 && !reachable[successor])
+            {
+                reachable[successor] = 1;
+                stack[top++] = successor;
+            }
+        }
+    }
+
+    free(stack);
+}
+
+void deleteControlFlowGraph(ControlFlowGraph* cfg)
+{
+    if(!cfg) return;
+
+    free(cfg->blocks);
+    free(cfg->blockOf);
+
+    cfg->blocks = NULL;
+    cfg->blockOf = NULL;
+    cfg->numberOfBlocks = 0;
+}
+
+int removeUnreachableBlocks(CodeBuffer* code)
+{
+    ControlFlowGraph cfg;
+
+    if(!code || !code->numberOfInstructions)
+        return 0;
+
+    if(buildControlFlowGraph(code, &cfg))
+        return -1;
+
+    char* reachable = (char*)malloc((size_t)cfg.numberOfBlocks);
+    char* removed = (char*)malloc((size_t)code->numberOfInstructions);
+
+    int result = -1;
+
+    if(reachable && removed)
+    {
+        markReachableBlocks(&cfg, reachable);
+
+        for(int i = 0; i < code->numberOfInstructions; i++)
+            removed[i] = !reachable[cfg.blockOf[i]];
+
+        result = removeInstructions(code, removed);
+    }
+
+    free(reachable);
+    free(removed);
+    deleteControlFlowGraph(&cfg);
+
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef __CFG_H__
+#define __CFG_H__
+
+#include "code_buffer.h"
+
+/**
+ * A basic block: a run of instructions that is only entered at its first
+ * .. instruction and only left after its last one.
+ * A block ending with a CAL has the called procedure and the instruction
+ * .. following the CAL, where the procedure returns to, as successors.
+ * */
+typedef struct {
+    int start, end;       // the instructions of the block are start..end-1
+    int successors[2];    // indices of the successor blocks, -1 if none
+} BasicBlock;
+
+/**
+ * Control-flow graph of PM/0 code. Block 0 is the entry of the code.
+ * */
+typedef struct {
+    BasicBlock* blocks;
+    int numberOfBlocks;
+    int* blockOf; // the block of each instruction
+} ControlFlowGraph;
+
+/**
+ * Builds the control-flow graph of the code of the given CodeBuffer into the
+ * .. given ControlFlowGraph. Returns 0 on success, -1 if the graph could not
+ * .. be allocated.
+ * */
+int buildControlFlowGraph(const CodeBuffer*, ControlFlowGraph*);
+
+/**
+ * Sets reachable[b] for every block b that can be reached from the entry.
+ * */
+void markReachableBlocks(const ControlFlowGraph*, char* reachable);
+
+/**
+ * Makes the necessary deallocations on the ControlFlowGraph.
+ * */
+void deleteControlFlowGraph(ControlFlowGraph*);
+
+/**
+ * Removes the basic blocks of the given code that cannot be reached from its
+ * .. entry, which includes the procedures that are never called from
+ * .. reachable code. Jump targets are relocated.
+ * Returns the number of instructions removed, -1 if the temporary space
+ * .. could not be allocated, in which case the code is left untouched.
+ * */
+int removeUnreachableBlocks(CodeBuffer*);
+
+#endif
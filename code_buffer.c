@@ -0,0 +1,155 @@
+#include "code_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+void initCodeBuffer(CodeBuffer* codeBuffer, int maxLength)
+{
+    codeBuffer->instructions = NULL;
+    codeBuffer->numberOfInstructions = 0;
+    codeBuffer->capacity = 0;
+    codeBuffer->maxLength = maxLength;
+    codeBuffer->overflowed = 0;
+    codeBuffer->labels = NULL;
+    codeBuffer->numberOfLabels = 0;
+    codeBuffer->labelCapacity = 0;
+}
+
+int emitInstruction(CodeBuffer* codeBuffer, int op, int r, int l, int m)
+{
+    if(codeBuffer->numberOfInstructions >= codeBuffer->maxLength)
+    {
+        codeBuffer->overflowed = 1;
+        return -1;
+    }
+
+    // Grow the allocated space geometrically if it is full
+    if(codeBuffer->numberOfInstructions == codeBuffer->capacity)
+    {
+        // The capacity is at least doubled, but never exceeds the limit
+        const int initialCapacity = 64;
+        int newCapacity = codeBuffer->capacity ? codeBuffer->capacity : initialCapacity / 2;
+
+        newCapacity = newCapacity > codeBuffer->maxLength / 2 ? codeBuffer->maxLength : 2 * newCapacity;
+
+        Instruction* instructions = (Instruction*)realloc(codeBuffer->instructions, newCapacity * sizeof(Instruction));
+
+        if(!instructions)
+        {
+            codeBuffer->overflowed = 1;
+            return -1;
+        }
+
+        codeBuffer->instructions = instructions;
+        codeBuffer->capacity = newCapacity;
+    }
+
+    codeBuffer->instructions[codeBuffer->numberOfInstructions] = (Instruction){ .op = op, .r = r, .l = l, .m = m };
+
+    return codeBuffer->numberOfInstructions++;
+}
+
+void addCodeLabel(CodeBuffer* codeBuffer, const char* name)
+{
+    int address = codeBuffer->numberOfInstructions;
+    int last = codeBuffer->numberOfLabels - 1;
+
+    // Nothing was emitted since the last label, which is now overridden
+    if(last >= 0 && codeBuffer->labels[last].address == address)
+        codeBuffer->numberOfLabels--;
+
+    if(codeBuffer->numberOfLabels == codeBuffer->labelCapacity)
+    {
+        int newCapacity = codeBuffer->labelCapacity ? 2 * codeBuffer->labelCapacity : 16;
+        CodeLabel* labels = (CodeLabel*)realloc(codeBuffer->labels, newCapacity * sizeof(CodeLabel));
+
+        if(!labels) return;
+
+        codeBuffer->labels = labels;
+        codeBuffer->labelCapacity = newCapacity;
+    }
+
+    CodeLabel* label = &codeBuffer->labels[codeBuffer->numberOfLabels++];
+
+    label->address = address;
+    strncpy(label->name, name, MAX_IDENTIFIER_LENGTH);
+    label->name[MAX_IDENTIFIER_LENGTH] = '\0';
+}
+
+void patchInstruction(CodeBuffer* codeBuffer, int index, int m)
+{
+    if(index < 0 || index >= codeBuffer->numberOfInstructions) return;
+
+    codeBuffer->instructions[index].m = m;
+}
+
+int removeInstructions(CodeBuffer* codeBuffer, const char* removed)
+{
+    int n = codeBuffer->numberOfInstructions;
+    int* newIndex = (int*)malloc(((size_t)n + 1) * sizeof(int));
+
+    if(!newIndex) return -1;
+
+    int kept = 0;
+    for(int i = 0; i < n; i++)
+    {
+        newIndex[i] = kept;
+        if(!removed[i]) kept++;
+    }
+    newIndex[n] = kept;
+
+    kept = 0;
+    for(int i = 0; i < n; i++)
+    {
+        if(removed[i]) continue;
+
+        Instruction ins = codeBuffer->instructions[i];
+
+        if((ins.op == JMP || ins.op == JPC || ins.op == CAL) && ins.m >= 0 && ins.m <= n)
+            ins.m = newIndex[ins.m];
+
+        codeBuffer->instructions[kept++] = ins;
+    }
+
+    codeBuffer->numberOfInstructions = kept;
+
+    // Labels whose code was removed end up at the same address as the next
+    // .. one, which then takes over
+    int numberOfLabels = 0;
+    for(int i = 0; i < codeBuffer->numberOfLabels; i++)
+    {
+        CodeLabel label = codeBuffer->labels[i];
+        label.address = newIndex[label.address];
+
+        if(numberOfLabels > 0 && codeBuffer->labels[numberOfLabels - 1].address == label.address)
+            numberOfLabels--;
+
+        codeBuffer->labels[numberOfLabels++] = label;
+    }
+
+    codeBuffer->numberOfLabels = numberOfLabels;
+
+    free(newIndex);
+
+    return n - codeBuffer->numberOfInstructions;
+}
+
+void printCodeBuffer(const CodeBuffer* codeBuffer, FILE* out)
+{
+    if(!codeBuffer || !out) return;
+
+    for(int i = 0; i < codeBuffer->numberOfInstructions; i++)
+    {
+        Instruction c = codeBuffer->instructions[i];
+        fprintf(out, "%d %d %d %d\n", c.op, c.r, c.l, c.m);
+    }
+}
+
+void deleteCodeBuffer(CodeBuffer* codeBuffer)
+{
+    if(!codeBuffer) return;
+
+    free(codeBuffer->instructions);
+    free(codeBuffer->labels);
+
+    initCodeBuffer(codeBuffer, codeBuffer->maxLength);
+}
@@ -0,0 +1,85 @@
+#ifndef __CODE_BUFFER_H__
+#define __CODE_BUFFER_H__
+
+#include <stdio.h>
+#include "data.h"
+
+/**
+ * A name given to the code from the labelled instruction on, up to the
+ * .. instruction of the next label, eg. the procedure it belongs to.
+ * */
+typedef struct {
+    int address;
+    char name[MAX_IDENTIFIER_LENGTH + 1]; // null-terminated, empty for the main block
+} CodeLabel;
+
+/**
+ * The growable array of instructions emitted by the code generator.
+ * The allocated space is grown geometrically, so emitting an instruction is
+ * .. O(1) amortized. The buffer never holds more than maxLength instructions:
+ * .. emitting beyond the limit fails and marks the buffer as overflowed.
+ * */
+typedef struct {
+    Instruction* instructions;
+    int numberOfInstructions;
+    int capacity;
+    int maxLength;  // hard limit on numberOfInstructions
+    int overflowed; // set once an instruction could not be emitted
+
+    // The labels of the code, in the order of their addresses. They are
+    // .. only debug information, so a label that could not be allocated is
+    // .. left out without failing the code.
+    CodeLabel* labels;
+    int numberOfLabels;
+    int labelCapacity;
+} CodeBuffer;
+
+/**
+ * Initializes the given CodeBuffer to an empty buffer that can hold at most
+ * .. maxLength instructions.
+ * */
+void initCodeBuffer(CodeBuffer*, int maxLength);
+
+/**
+ * Appends the instruction whose fields are given as parameters and returns
+ * .. its index. If the limit is reached or the allocation fails, sets the
+ * .. overflowed flag and returns -1.
+ * */
+int emitInstruction(CodeBuffer*, int op, int r, int l, int m);
+
+/**
+ * Labels the next instruction to be emitted with the given name, which is
+ * .. truncated to MAX_IDENTIFIER_LENGTH characters. A later label at the
+ * .. same address replaces it.
+ * */
+void addCodeLabel(CodeBuffer*, const char* name);
+
+/**
+ * Sets the M field of the instruction at the given index, eg. to resolve the
+ * .. target of a forward jump. Indices that were not emitted, which can only
+ * .. happen after the buffer overflowed, are ignored.
+ * */
+void patchInstruction(CodeBuffer*, int index, int m);
+
+/**
+ * Drops the instructions i for which removed[i] is set and relocates the
+ * .. targets of JMP, JPC and CAL. A jump to a removed instruction jumps to
+ * .. the instruction that followed it, which is where execution continued
+ * .. from the removed one. Labels are relocated the same way.
+ * Returns the number of instructions removed, -1 if the temporary space
+ * .. could not be allocated, in which case the code is left untouched.
+ * */
+int removeInstructions(CodeBuffer*, const char* removed);
+
+/**
+ * Prints the instructions of the given CodeBuffer to the given file, one
+ * .. instruction per line as "op r l m", which is the format the VM loads.
+ * */
+void printCodeBuffer(const CodeBuffer*, FILE*);
+
+/**
+ * Makes the necessary deallocations on the CodeBuffer and resets it to empty.
+ * */
+void deleteCodeBuffer(CodeBuffer*);
+
+#endif
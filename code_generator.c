@@ -1,833 +1,925 @@
-#include "token.h"
-#include "data.h"
-#include "symbol.h"
-#include <string.h>
-#include <stdlib.h>
-
-/**
- * This pointer is set when by codeGenerator() func and used by printEmittedCode() func.
- *
- * You are not required to use it anywhere. The implemented part of the skeleton
- * handles the printing. Instead, you are required to fill the vmCode properly by making
- * use of emit() func.
- * */
-FILE* _out;
-
-/**
- * Token list iterator used by the code generator. It will be set once entered to
- * codeGenerator() and reset before exiting codeGenerator().
- *
- * It is better to use the given helper functions to make use of token list iterator.
- * */
-TokenListIterator _token_list_it;
-
-/**
- * Current level. Use this to keep track of the current level for the symbol table entries.
- * */
-unsigned int currentLevel;
-
-/**
- * Current scope. Use this to keep track of the current scope for the symbol table entries.
- * NULL means global scope.
- * */
-Symbol* currentScope;
-
-/**
- * Symbol table.
- * */
-SymbolTable symbolTable;
-
-/**
- * The array of instructions that the generated(emitted) code will be held.
- * */
-Instruction vmCode[MAX_CODE_LENGTH];
-
-/**
- * The next index in the array of instructions (vmCode) to be filled.
- * */
-int nextCodeIndex;
-
-/**
- * The id of the register currently being used.
- * */
-int currentReg;
-
-/**
- * Emits the instruction whose fields are given as parameters.
- * Internally, writes the instruction to vmCode[nextCodeIndex] and returns the
- * nextCodeIndex by post-incrementing it.
- * If MAX_CODE_LENGTH is reached, prints an error message on stderr and exits.
- * */
-int emit(int OP, int R, int L, int M);
-
-/**
- * Prints the emitted code array (vmCode) to output file.
- *
- * This func is called in the given codeGenerator() function. You are not required
- * to have another call to this function in your code.
- * */
-void printEmittedCodes();
-
-/**
- * Returns the current token using the token list iterator.
- * If it is the end of tokens, returns token with id nulsym.
- * */
-Token getCurrentToken();
-
-/**
- * Returns the type of the current token. Returns nulsym if it is the end of tokens.
- * */
-int getCurrentTokenType();
-
-/**
- * Advances the position of TokenListIterator by incrementing the current token
- * index by one.
- * */
-void nextToken();
-
-/**
- * Functions used for non-terminals of the grammar
- *
- * rel-op func is removed on purpose. For code generation, it is easier to parse
- * rel-op as a part of condition.
- * */
-int program();
-int block();
-int const_declaration();
-int var_declaration();
-int proc_declaration();
-int statement();
-int condition();
-int expression();
-int term();
-int factor();
-
-/******************************************************************************/
-/* Definitions of helper functions starts *************************************/
-/******************************************************************************/
-
-Token getCurrentToken()
-{
-    return getCurrentTokenFromIterator(_token_list_it);
-}
-
-int getCurrentTokenType()
-{
-    return getCurrentToken().id;
-}
-
-void nextToken()
-{
-    _token_list_it.currentTokenInd++;
-}
-
-/**
- * Given the code generator error code, prints error message on file by applying
- * required formatting.
- * */
-void printCGErr(int errCode, FILE* fp)
-{
-    if(!fp || !errCode) return;
-
-    fprintf(fp, "CODE GENERATOR ERROR[%d]: %s.\n", errCode, codeGeneratorErrMsg[errCode]);
-}
-
-int emit(int OP, int R, int L, int M)
-{
-    if(nextCodeIndex == MAX_CODE_LENGTH)
-    {
-        fprintf(stderr, "MAX_CODE_LENGTH(%d) reached. Emit is unsuccessful: terminating code generator..\n", MAX_CODE_LENGTH);
-        exit(0);
-    }
-
-    vmCode[nextCodeIndex] = (Instruction){ .op = OP, .r = R, .l = L, .m = M};
-
-    return nextCodeIndex++;
-}
-
-void printEmittedCodes()
-{
-    for(int i = 0; i < nextCodeIndex; i++)
-    {
-        Instruction c = vmCode[i];
-        fprintf(_out, "%d %d %d %d\n", c.op, c.r, c.l, c.m);
-    }
-}
-
-/******************************************************************************/
-/* Definitions of helper functions ends ***************************************/
-/******************************************************************************/
-
-/**
- * Advertised codeGenerator function. Given token list, which is possibly the
- * output of the lexer, parses a program out of tokens and generates code.
- * If encountered, returns the error code.
- *
- * Returning 0 signals successful code generation.
- * Otherwise, returns a non-zero code generator error code.
- * */
-int codeGenerator(TokenList tokenList, FILE* out)
-{
-    // Set output file pointer
-    _out = out;
-
-    /**
-     * Create a token list iterator, which helps to keep track of the current
-     * token being parsed.
-     * */
-    _token_list_it = getTokenListIterator(&tokenList);
-
-    // Initialize current level to 0, which is the global level
-    currentLevel = 0;
-
-    // Initialize current scope to NULL, which is the global scope
-    currentScope = NULL;
-
-    // The index on the vmCode array that the next emitted code will be written
-    nextCodeIndex = 0;
-
-    // The id of the register currently being used
-    currentReg = 0;
-
-    // Initialize symbol table
-    initSymbolTable(&symbolTable);
-
-    // Start parsing by parsing program as the grammar suggests.
-    int err = program();
-
-    // Print symbol table - if no error occured
-    if(!err)
-    {
-        // Print the emitted codes to the file
-        printEmittedCodes();
-    }
-
-    // Reset output file pointer
-    _out = NULL;
-
-    // Reset the global TokenListIterator
-    _token_list_it.currentTokenInd = 0;
-    _token_list_it.tokenList = NULL;
-
-    // Delete symbol table
-    deleteSymbolTable(&symbolTable);
-
-    // Return err code - which is 0 if parsing was successful
-    return err;
-}
-
-// Already implemented.
-int program()
-{
-	// Generate code for block
-    int err = block();
-    if(err) return err;
-
-    // After parsing block, periodsym should show up
-    if( getCurrentTokenType() == periodsym )
-    {
-        // Consume token
-        nextToken();
-
-        // End of program, emit halt code
-        emit(SIO_HALT, 0, 0, 3);
-
-        return 0;
-    }
-    else
-    {
-        // Periodsym was expected. Return error code 6.
-        return 6;
-    }
-}
-
-int block()
-{
-    int err;
-
-    Symbol tempScope;
-    tempScope.scope = currentScope;
-
-    if(currentScope != NULL)
-        emit(INC,0,0,4);
-
-    err = const_declaration();
-    if(err)
-        return err;
-    err = var_declaration();
-    if(err)
-        return err;
-    err = proc_declaration();
-    if(err)
-        return err;
-    currentScope = &tempScope;
-    err = statement();
-    if(err)
-        return err;
-    currentScope = tempScope.scope;
-    return 0;
-}
-
-int const_declaration()
-{
-
-    Symbol symbol;
-    Token token;
-    symbol.type = CONST;
-    symbol.level = currentLevel;
-
-    if(getCurrentTokenType() != constsym)
-    {
-        return 0;
-    }
-
-    nextToken();
-    if(getCurrentTokenType() != identsym)
-    {
-        return 3;
-    }
-
-    token = getCurrentToken();
-    strcpy(symbol.name, token.lexeme);
-    nextToken();
-
-    if(getCurrentTokenType() != eqsym)
-    {
-        return 2;
-    }
-
-    nextToken();
-    if(getCurrentTokenType() != numbersym)
-    {
-        return 1;
-    }
-
-    token = getCurrentToken();
-    symbol.value = atoi(token.lexeme);
-
-    symbol.scope = currentScope; //add current scope to symbol table
-    nextToken();
-    addSymbol(&symbolTable,symbol);
-
-    while(getCurrentTokenType() == commasym)
-    {
-
-        nextToken();
-        if(getCurrentTokenType() != identsym)
-            return 3;
-
-
-        token = getCurrentToken();
-        strcpy(symbol.name, token.lexeme);
-        nextToken();
-
-        if(getCurrentTokenType() != eqsym)
-        {
-            return 2;
-        }
-
-        nextToken();
-        if(getCurrentTokenType() != numbersym)
-        {
-            return 1;
-        }
-
-        token = getCurrentToken();
-        symbol.value = atoi(token.lexeme);
-
-        symbol.scope = currentScope;// add current scope to symbol table
-        nextToken();
-        addSymbol(&symbolTable,symbol);
-    }
-    if(getCurrentTokenType() != semicolonsym)
-        return 4;
-
-    nextToken();
-
-    return 0;
-}
-
-int var_declaration()
-{
-    if(getCurrentTokenType() != varsym)
-        return 0;
-
-    Symbol symbol;
-    symbol.type = VAR;
-    symbol.level = currentLevel;
-    symbol.scope = currentScope;
-    Token token;
-    int varNum = 0;
-    emit(INC,0,0,2);
-
-    while(1){
-        if(getCurrentTokenType() == varsym || getCurrentTokenType() == commasym){
-            varNum++;
-            nextToken();
-            if(getCurrentTokenType() == identsym){
-
-                token = getCurrentToken();
-                strcpy(symbol.name, token.lexeme);
-                nextToken();
-                if(getCurrentTokenType() == eqsym){
-
-                    nextToken();
-                    if(getCurrentTokenType() == numbersym){
-
-                        token = getCurrentToken();
-                        symbol.value = atoi(token.lexeme);
-                        symbol.address = 4 * currentLevel + varNum;
-                        nextToken();
-                        if(getCurrentTokenType() == semicolonsym){
-
-                            nextToken();
-                            break;
-                        }
-                        else if(getCurrentTokenType() != commasym && getCurrentTokenType() != semicolonsym){
-                            return 4;
-                        }
-                        addSymbol(&symbolTable,symbol);
-                    }
-                    else{
-                        return 1;
-                    }
-                }
-                else if(getCurrentTokenType() == semicolonsym){
-
-                    nextToken();
-                    symbol.address = 4 * currentLevel + varNum;
-                    addSymbol(&symbolTable,symbol);
-                    break;
-                }
-                else if(getCurrentTokenType() == commasym){
-                    symbol.address = 4 * currentLevel + varNum;
-                    addSymbol(&symbolTable,symbol);
-                }
-                else{
-                    return 4;
-                }
-            }
-            else{
-                return 3;
-            }
-        }
-        else{
-            break;
-        }
-    }
-    return 0;
-}
-
-int proc_declaration()
-{
-    int err;
-    Token token;
-    Symbol symbol;
-    int tmpscope = 0;
-
-    int varNum = 0, procTrue = 0;
-    symbol.type = PROC;
-    int codeIndex = nextCodeIndex;
-    if(getCurrentTokenType() == procsym){
-        emit(JMP,0,0,0);
-        procTrue = 1;
-    }
-
-    while(getCurrentTokenType() == procsym)
-    {
-        varNum++;
-        nextToken();
-        if(getCurrentTokenType() != identsym){
-            return 3;
-        }
-        token = getCurrentToken();
-        strcpy(symbol.name, token.lexeme);
-        nextToken();
-        if(getCurrentTokenType() != semicolonsym){
-                return 5;
-        }
-        nextToken();
-        symbol.scope = currentScope;
-        symbol.level = currentLevel;
-        symbol.address = nextCodeIndex;
-        addSymbol(&symbolTable,symbol);
-
-        currentScope++;
-        currentLevel++;
-        err = block();
-        currentLevel--;
-        currentScope--;
-
-        if(err)
-            return err;
-        if(getCurrentTokenType() != semicolonsym)
-        {
-            return 5;
-        }
-        nextToken();
-    }
-    if(procTrue == 1)
-        emit(RTN,0,0,0);
-    vmCode[codeIndex].m = nextCodeIndex;
-
-    return 0;
-}
-
-int statement()
-{
-	int err = 0, jmp, jmp2;
-	Symbol* currSym;
-
-    if(getCurrentTokenType() == identsym)
-	{
-		currSym = findSymbol(&symbolTable, currentScope, getCurrentToken().lexeme);
-
-		if(currSym->scope != currentScope)
-			return 15;
-		if(currSym->type != VAR)
-			return 16;
-
-		nextToken();
-		if(getCurrentTokenType() != becomessym)
-			return 7;
-
-		// Get next token and pass to expression.
-		nextToken();
-		err = expression();
-		if(err != 0)
-			return err;
-	}
-	// Statement that begins w call symbol.
-	else if(getCurrentTokenType() == callsym)
-	{
-		nextToken();
-		if(getCurrentTokenType() != identsym)
-			return 8;
-
-		currSym = findSymbol(&symbolTable, currentScope, getCurrentToken().lexeme);
-
-		// Check scope/type of symbol.
-		if(currSym->scope != currentScope)
-			return 15;
-		if(currSym->type == PROC)
-			emit(CAL, 0, currentLevel - currSym->level, currSym->address);
-		else
-			return 17;
-
-
-		nextToken();
-	}
-
-	else if(getCurrentTokenType() == beginsym)
-	{
-		nextToken();
-		err = statement();
-		if(err != 0)
-			return err;
-
-		while (getCurrentTokenType() == semicolonsym)
-		{
-			// Get next token and pass to statement.
-			nextToken();
-			err = statement();
-			if(err != 0)
-				return err;
-		}
-
-		if(getCurrentTokenType() != endsym)
-			return 10;
-		nextToken();
-	}
-
-	else if(getCurrentTokenType() == ifsym)
-	{
-		nextToken();
-		err = condition();
-		if(err != 0)
-			return err;
-
-		if(getCurrentTokenType() != thensym)
-			return 9;
-
-		nextToken();
-
-		jmp = nextCodeIndex;
-		emit(JPC, 0, 0, 0);
-
-		err = statement();
-		if(err != 0)
-			return err;
-
-		vmCode[jmp].m = nextCodeIndex;
-
-		if(getCurrentTokenType() == elsesym)
-		{
-			jmp2 = nextCodeIndex;
-			emit(JMP, 0, 0, 0);
-
-			// Get next token & update  jump address
-			nextToken();
-			vmCode[jmp2].m = nextCodeIndex;
-
-			err = statement();
-			if(err != 0)
-				return err;
-
-			vmCode[jmp].m = nextCodeIndex;
-		}
-	}
-	else if(getCurrentTokenType() == whilesym)
-	{
-		jmp = nextCodeIndex;
-
-		nextToken();
-		err = condition();
-		if(err != 0)
-			return err;
-
-		jmp2 = nextCodeIndex;
-		emit(JPC, 0, 0, 0);
-
-		if(getCurrentTokenType() != dosym)
-			return 11;
-
-		nextToken();
-		err = statement();
-		if(err != 0)
-			return err;
-
-		emit(JMP, 0, 0, jmp);
-		vmCode[jmp2].m = nextCodeIndex;
-	}
-	else if(getCurrentTokenType() == writesym)
-	{
-
-		nextToken();
-		if(getCurrentTokenType() != identsym)
-			return 3;
-
-		// Get symbol and check scope/type.
-		currSym = findSymbol(&symbolTable, currentScope, getCurrentToken().lexeme);
-		if(currSym->scope != currentScope)
-			return 15;
-		if(currSym->type == PROC)
-			return 18;
-
-		emit(LOD, 0, currentLevel - currSym->level, currSym->address);
-		emit(SIO_WRITE, 0, 0, 0);
-
-
-		nextToken();
-	}
-
-	else if(getCurrentTokenType() == readsym)
-	{
-		emit(SIO_READ, 0, 0, 0);
-
-		nextToken();
-		if(getCurrentTokenType() != identsym)
-			return 3;
-
-		// Get symbol and check scope/type.
-		currSym = findSymbol(&symbolTable, currentScope, getCurrentToken().lexeme);
-		if(currSym->scope != currentScope)
-			return 15;
-		if(currSym->type != VAR)
-			return 19;
-
-		nextToken();
-		emit(STO, 0, currentLevel - currSym->level, currSym->address);
-	}
-
-    return 0;
-}
-
-int condition()
-{
-    int err;
-
-    if(getCurrentTokenType() == oddsym){
-
-        nextToken();
-        err = expression();
-        if(err)
-            return err;
-        emit(ODD,currentReg,0,0);
-    }
-    else{
-        err = expression();
-        if(err)
-            return err;
-
-        if(getCurrentTokenType() == eqsym)
-        {
-            emit(EQL,currentReg,0,0);
-            nextToken();
-            return 0;
-        }
-        else if(getCurrentTokenType() == neqsym)
-        {
-            emit(NEQ,currentReg,0,0);
-            nextToken();
-            return 0;
-        }
-        else if(getCurrentTokenType() == lessym)
-        {
-            emit(LSS,currentReg,0,0);
-            nextToken();
-            return 0;
-        }
-        else if(getCurrentTokenType() == leqsym)
-        {
-            emit(LEQ,currentReg,0,0);
-            nextToken();
-            return 0;
-        }
-        else if(getCurrentTokenType() == gtrsym)
-        {
-            emit(GTR,currentReg,0,0);
-            nextToken();
-            return 0;
-        }
-        else if(getCurrentTokenType() == geqsym)
-        {
-            emit(GEQ,currentReg,0,0);
-            nextToken();
-            return 0;
-        }
-        else
-        {
-            return 12;
-        }
-
-        err = expression();
-        if(err)
-            return err;
-    }
-
-    return 0;
-}
-
-int expression()
-{
-	int err = 0;
-	int op = getCurrentTokenType();
-
-
-    if(op == plussym || op == minussym)
-	{
-		nextToken();
-
-		err = term();
-		if(err != 0)
-			return err;
-
-		if(op == minussym)
-			emit(NEG, 0, 0, 0);
-	}
-
-	err = term();
-	if(err != 0)
-		return err;
-
-
-	// Continue parsing
-	while(op == plussym || op == minussym)
-	{
-		nextToken();
-
-		err = term();
-		if(err != 0)
-			return err;
-
-		if(op == plussym)
-			emit(ADD, 0, 0, 0);
-		else
-			emit(SUB, 0, 0, 0);
-	}
-
-    return 0;
-}
-
-int term()
-{
-	int err = 0;
-	int op = getCurrentTokenType();
-
-    err = factor();
-	if(err != 0)
-		return err;
-
-	// Continue parsing
-	while(op == multsym || op == slashsym)
-	{
-		nextToken();
-
-		err = factor();
-		if(err != 0)
-			return err;
-
-		if(op == multsym)
-			emit(MUL, 0, 0, 0);
-		else
-			emit(DIV, 0, 0, 0);
-	}
-
-    return 0;
-}
-
-int factor()
-{
-
-	Symbol* currSym = findSymbol(&symbolTable, currentScope, getCurrentToken().lexeme);
-	if(currSym == NULL)
-		return 15;
-
-    if(getCurrentTokenType() == identsym)
-    {
-		if(currSym->type == PROC)
-			return 14;
-		else if(currSym->type == CONST)
-			emit(LIT, 0, 0, currSym->value);
-		else
-			emit(LOD, 0, currentLevel - currSym->level, currSym->address);
-
-        nextToken();
-
-        return 0;
-    }
-    else if(getCurrentTokenType() == numbersym)
-    {
-		int value = atoi(getCurrentToken().lexeme);
-		emit(LIT, 0, 0, value);
-
-        nextToken();
-
-        return 0;
-    }
-
-    else if(getCurrentTokenType() == lparentsym)
-    {
-        nextToken();
-
-        // Continue parsing expression
-        int err = expression();
-
-        if(err) return err;
-
-
-        if(getCurrentTokenType() != rparentsym)
-        {
-            return 13;
-        }
-
-
-        nextToken();
-    }
-    else
-    {
-        return 24;
-    }
-
-    return 0;
-}
+#include "token.h"
+#include "data.h"
+#include "ast.h"
+#include "code_buffer.h"
+#include "peephole.h"
+#include "cfg.h"
+#include "code_generator.h"
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+/**
+ * A node of an expression tree. Leaves load a value into a register; inner
+ * .. nodes combine the registers of their children. Unary nodes are NEG, ODD
+ * .. or ADD, which doubles its child by adding its register to itself.
+ * */
+typedef struct {
+    int op;          // LIT, LOD, NEG, ODD or one of ADD..DIV, EQL..GEQ
+    int l, m;        // the L and M fields of a LIT or LOD
+    int left, right; // indices of the children, -1 if none
+    int need;        // the number of registers needed to evaluate the node without spilling
+} ExprNode;
+
+/**
+ * The state of a single run of the code generator. Every function of the code
+ * generator takes the context it works on as its first parameter, so that
+ * independent runs, eg. on different threads, do not share any state.
+ * */
+typedef struct {
+    /**
+     * The abstract syntax tree of the program, built by buildAst() before
+     * .. any code is emitted.
+     * */
+    Ast ast;
+
+    /**
+     * The tokens the tree was built from. The AST_PROC nodes refer to their
+     * .. names in it.
+     * */
+    const Token* tokens;
+
+    /**
+     * Current level: the nesting level of the block being compiled.
+     * */
+    unsigned int currentLevel;
+
+    /**
+     * The name of the procedure whose block is being compiled, empty for the
+     * .. main block. The code is labelled with it (see addCodeLabel()).
+     * */
+    const char* blockName;
+
+    /**
+     * The address of the code of each procedure, indexed by its AST_PROC
+     * .. node. It is set before the block of the procedure is compiled, so
+     * .. recursive calls find it too.
+     * */
+    int* procAddresses;
+
+    /**
+     * Whether dead code is left out: procedures that are never called, and
+     * .. the branches of conditions that are known at compile time.
+     * .. isCalled, indexed by AST_PROC node, is set by markCalledProcedures().
+     * */
+    int eliminateDeadCode;
+    char* isCalled;
+
+    /**
+     * The procedures whose calls are replaced by their statements, indexed
+     * .. by AST_PROC node, and the addresses their variables are given in
+     * .. the activation record of the block they are inlined into, indexed
+     * .. by AST_VAR node. The address of a variable is -1 unless the
+     * .. statements of its procedure are being compiled inline.
+     * */
+    char* isInlinable;
+    int* inlinedAddresses;
+
+    /**
+     * The buffer of instructions that the generated(emitted) code will be held.
+     * The index of the next instruction to be emitted is code.numberOfInstructions.
+     * */
+    CodeBuffer code;
+
+    /**
+     * The nodes of the expression trees, which are built from the expressions
+     * .. of the AST and then compiled by compileExpression(). Every node is
+     * .. built from an AST node of the expression of a statement, and the
+     * .. pool is emptied before each statement, so it is allocated once, with
+     * .. room for a node per AST node. Should it still run out, the
+     * .. compilation fails as if the code were too long (see newExprNode()).
+     * */
+    ExprNode* exprNodes;
+    int numberOfExprNodes;
+    int exprNodeCapacity;
+    int exprNodesOverflowed;
+
+    /**
+     * The activation record layout of the block being compiled: the number
+     * .. of its variables, including those of the procedures being inlined,
+     * .. and the temporaries holding spilled registers, which follow the
+     * .. variables. frameSize is the size the activation record needs.
+     * */
+    int numberOfVariables;
+    int spillDepth;
+    int frameSize;
+} CodeGenContext;
+
+/**
+ * Emits the instruction whose fields are given as parameters.
+ * Internally, appends the instruction to the code of the context and returns
+ * its index. If the maximum code length is reached, returns -1;
+ * compileTokenList() then reports the overflow as a code generator error.
+ * */
+int emit(CodeGenContext* ctx, int OP, int R, int L, int M);
+
+/**
+ * Returns the AST node at the given index.
+ * */
+AstNode* getNode(CodeGenContext* ctx, int node);
+
+/**
+ * Functions emitting the code of the AST nodes, walking the tree from the
+ * .. main block down. Errors are all found while building the tree, so the
+ * .. only failure left, a code overflow, is recorded by the code buffer.
+ * */
+void program(CodeGenContext* ctx);
+void block(CodeGenContext* ctx, int node);
+void proc_declaration(CodeGenContext* ctx, int declarations);
+void statement(CodeGenContext* ctx, int node);
+
+/**
+ * Sets l and m to the L and M fields addressing the variable declared by
+ * .. the given AST_VAR node from the block being compiled.
+ * */
+void variableAddress(CodeGenContext* ctx, int declaration, int* l, int* m);
+
+/**
+ * Compiles the statement of the given procedure in place of a call to it.
+ * Its variables are given slots after those of the block being compiled,
+ * .. which they are addressed in with level 0. The other variables and the
+ * .. procedures it uses are declared in the blocks enclosing both the
+ * .. procedure and the caller, so they are addressed from the block being
+ * .. compiled as usual.
+ * */
+void inlineProcedure(CodeGenContext* ctx, int proc);
+
+/**
+ * Sets isInlinable for the procedures whose calls are compiled inline: those
+ * .. that cannot call themselves, declare no procedures, and whose statement
+ * .. has at most threshold AST nodes. No procedure is inlined if threshold
+ * .. is 0.
+ * */
+void findInlinableProcedures(CodeGenContext* ctx, int threshold);
+
+/**
+ * Builds the expression tree of the given AST expression and returns the
+ * .. index of its root. The tree is compiled by compileExpression().
+ * */
+int expression(CodeGenContext* ctx, int node);
+
+/**
+ * Adds a node to the expression tree pool and returns its index. The number
+ * .. of registers the node needs is computed from its children (Sethi-Ullman
+ * .. numbering). If the pool is full, exprNodesOverflowed is set and a
+ * .. placeholder leaf is returned.
+ * */
+int newExprNode(CodeGenContext* ctx, int op, int l, int m, int left, int right);
+
+/**
+ * Adds a node applying the given operator to the given children, which are
+ * .. simplified first: operations on literals are evaluated at compile time
+ * .. and identities such as x + 0, x * 1 and -(-x) are removed. right is -1
+ * .. for the unary operators. Returns the index of the resulting node, which
+ * .. might be one of the children. At most one node is added per AST node
+ * .. of the expression.
+ * */
+int foldExprNode(CodeGenContext* ctx, int op, int left, int right);
+
+/**
+ * Emits the code evaluating the expression tree rooted at node into register
+ * .. reg, using only the registers from reg up. Subtrees needing more
+ * .. registers than available are spilled to temporaries of the activation
+ * .. record.
+ * */
+void compileExpression(CodeGenContext* ctx, int node, int reg);
+
+/******************************************************************************/
+/* Definitions of helper functions starts *************************************/
+/******************************************************************************/
+
+AstNode* getNode(CodeGenContext* ctx, int node)
+{
+    return getAstNode(&ctx->ast, node);
+}
+
+/**
+ * Given the code generator error code, prints error message on file by applying
+ * required formatting.
+ * */
+void printCGErr(int errCode, FILE* fp)
+{
+    if(!fp || !errCode) return;
+
+    fprintf(fp, "CODE GENERATOR ERROR[%d]: %s.\n", errCode, codeGeneratorErrMsg[errCode]);
+}
+
+int emit(CodeGenContext* ctx, int OP, int R, int L, int M)
+{
+    return emitInstruction(&ctx->code, OP, R, L, M);
+}
+
+int newExprNode(CodeGenContext* ctx, int op, int l, int m, int left, int right)
+{
+    // Past the capacity, a leaf is built in the spare node after it instead,
+    // .. so that the trees stay finite until the compilation fails
+    if(ctx->numberOfExprNodes >= ctx->exprNodeCapacity)
+    {
+        ExprNode* spare = &ctx->exprNodes[ctx->exprNodeCapacity];
+
+        spare->op = LIT;
+        spare->l = 0;
+        spare->m = 0;
+        spare->left = -1;
+        spare->right = -1;
+        spare->need = 1;
+
+        ctx->exprNodesOverflowed = 1;
+
+        return ctx->exprNodeCapacity;
+    }
+
+    ExprNode* node = &ctx->exprNodes[ctx->numberOfExprNodes];
+
+    node->op = op;
+    node->l = l;
+    node->m = m;
+    node->left = left;
+    node->right = right;
+
+    if(left < 0)
+    {
+        // A leaf needs the register it is loaded into
+        node->need = 1;
+    }
+    else if(right < 0)
+    {
+        // A unary node is evaluated in the register of its child
+        node->need = ctx->exprNodes[left].need;
+    }
+    else
+    {
+        // The child evaluated second needs one more register, as the result
+        // .. of the first one is held meanwhile. Evaluating the child with
+        // .. the larger need first hides that register, unless needs are equal.
+        int leftNeed = ctx->exprNodes[left].need;
+        int rightNeed = ctx->exprNodes[right].need;
+
+        node->need = leftNeed == rightNeed ? leftNeed + 1 : (leftNeed > rightNeed ? leftNeed : rightNeed);
+    }
+
+    return ctx->numberOfExprNodes++;
+}
+
+/**
+ * Returns whether the given node is a literal, and if so, sets value to it.
+ * */
+static int isLiteral(CodeGenContext* ctx, int node, int* value)
+{
+    if(ctx->exprNodes[node].op != LIT)
+        return 0;
+
+    *value = ctx->exprNodes[node].m;
+    return 1;
+}
+
+/**
+ * Returns whether evaluating the given tree can fault, ie., it divides.
+ * */
+static int mayFault(CodeGenContext* ctx, int node)
+{
+    const ExprNode* n = &ctx->exprNodes[node];
+
+    if(n->op == DIV)
+        return 1;
+
+    return (n->left >= 0 && mayFault(ctx, n->left)) || (n->right >= 0 && mayFault(ctx, n->right));
+}
+
+/**
+ * Evaluates the given operator on the given operands the way the VM does:
+ * .. arithmetic wraps around. Returns 0 and sets result on success, -1 if
+ * .. the VM would fault, in which case the operation is left to run time.
+ * */
+static int evaluate(int op, int a, int b, int* result)
+{
+    switch(op)
+    {
+        case NEG: *result = (int)(0u - (unsigned)a); break;
+        case ODD: *result = a % 2; break;
+        case ADD: *result = (int)((unsigned)a + (unsigned)b); break;
+        case SUB: *result = (int)((unsigned)a - (unsigned)b); break;
+        case MUL: *result = (int)((unsigned)a * (unsigned)b); break;
+        case DIV:
+            if(b == 0 || (a == INT_MIN && b == -1)) return -1;
+            *result = a / b;
+            break;
+        case EQL: *result = a == b; break;
+        case NEQ: *result = a != b; break;
+        case LSS: *result = a <  b; break;
+        case LEQ: *result = a <= b; break;
+        case GTR: *result = a >  b; break;
+        case GEQ: *result = a >= b; break;
+        default:
+            return -1;
+    }
+
+    return 0;
+}
+
+int foldExprNode(CodeGenContext* ctx, int op, int left, int right)
+{
+    int a, b, value;
+    int leftIsLiteral = isLiteral(ctx, left, &a);
+    int rightIsLiteral = right >= 0 && isLiteral(ctx, right, &b);
+
+    if(right < 0)
+    {
+        if(leftIsLiteral && !evaluate(op, a, 0, &value))
+            return newExprNode(ctx, LIT, 0, value, -1, -1);
+
+        // -(-x) is x
+        if(op == NEG && ctx->exprNodes[left].op == NEG && ctx->exprNodes[left].right < 0)
+            return ctx->exprNodes[left].left;
+
+        return newExprNode(ctx, op, 0, 0, left, -1);
+    }
+
+    if(leftIsLiteral && rightIsLiteral && !evaluate(op, a, b, &value))
+        return newExprNode(ctx, LIT, 0, value, -1, -1);
+
+    // Put the literal operand of commutative operators on the right
+    if(leftIsLiteral && !rightIsLiteral && (op == ADD || op == MUL))
+    {
+        int node = left;
+        left = right;
+        right = node;
+
+        b = a;
+        leftIsLiteral = 0;
+        rightIsLiteral = 1;
+    }
+
+    if(rightIsLiteral)
+    {
+        switch(op)
+        {
+        case ADD:
+        case SUB:
+            if(b == 0)
+                return left;
+
+            // Arithmetic wraps around, so (x + c1) + c2 is x + (c1 + c2)
+            // .. whatever the values are. The left node is reused.
+            if((ctx->exprNodes[left].op == ADD || ctx->exprNodes[left].op == SUB) &&
+                ctx->exprNodes[left].right >= 0 && isLiteral(ctx, ctx->exprNodes[left].right, &a))
+            {
+                ExprNode* n = &ctx->exprNodes[left];
+                unsigned sum = (n->op == ADD ? (unsigned)a : 0u - (unsigned)a) +
+                               (op == ADD ? (unsigned)b : 0u - (unsigned)b);
+
+                if(sum == 0)
+                    return n->left;
+
+                n->op = ADD;
+                ctx->exprNodes[n->right].m = (int)sum;
+
+                return left;
+            }
+            break;
+
+        case MUL:
+            if(b == 1)
+                return left;
+            if(b == -1)
+                return newExprNode(ctx, NEG, 0, 0, left, -1);
+            if(b == 0 && !mayFault(ctx, left))
+                return newExprNode(ctx, LIT, 0, 0, -1, -1);
+
+            // x * 2 is x + x, which needs no register for the literal
+            if(b == 2)
+                return newExprNode(ctx, ADD, 0, 0, left, -1);
+            break;
+
+        case DIV:
+            // Division by other powers of two cannot be reduced: the VM
+            // .. has no shifts, and division truncates negative values
+            if(b == 1)
+                return left;
+            break;
+        }
+    }
+    else if(leftIsLiteral && a == 0 && op == SUB)
+    {
+        // 0 - x is -x
+        return newExprNode(ctx, NEG, 0, 0, right, -1);
+    }
+
+    return newExprNode(ctx, op, 0, 0, left, right);
+}
+
+void compileExpression(CodeGenContext* ctx, int node, int reg)
+{
+    const ExprNode* n = &ctx->exprNodes[node];
+
+    if(n->left < 0)
+    {
+        emit(ctx, n->op, reg, n->l, n->m);
+        return;
+    }
+
+    if(n->right < 0)
+    {
+        compileExpression(ctx, n->left, reg);
+        emit(ctx, n->op, reg, reg, n->op == ADD ? reg : 0);
+        return;
+    }
+
+    int leftFirst = ctx->exprNodes[n->left].need >= ctx->exprNodes[n->right].need;
+    int first = leftFirst ? n->left : n->right;
+    int second = leftFirst ? n->right : n->left;
+
+    // The registers from reg up are available. Both children are evaluated in
+    // .. registers if the second one fits next to the result of the first.
+    if(ctx->exprNodes[second].need <= REGISTER_FILE_REG_COUNT - reg - 1)
+    {
+        compileExpression(ctx, first, reg);
+        compileExpression(ctx, second, reg + 1);
+    }
+    else
+    {
+        // Otherwise, the result of the first child is kept in a temporary
+        // .. while the second one uses all the registers
+        int temporary = AR_VARIABLE_OFFSET + ctx->numberOfVariables + ctx->spillDepth;
+
+        compileExpression(ctx, first, reg);
+        emit(ctx, STO, reg, 0, temporary);
+
+        ctx->spillDepth++;
+        if(temporary + 1 > ctx->frameSize)
+            ctx->frameSize = temporary + 1;
+
+        compileExpression(ctx, second, reg);
+
+        ctx->spillDepth--;
+
+        // The first child is reloaded after the second, so the registers
+        // .. hold the operands the other way around
+        emit(ctx, LOD, reg + 1, 0, temporary);
+        leftFirst = !leftFirst;
+    }
+
+    // Emit the operation on the registers holding the left and the right operands
+    if(leftFirst)
+        emit(ctx, n->op, reg, reg, reg + 1);
+    else
+        emit(ctx, n->op, reg, reg + 1, reg);
+}
+
+/******************************************************************************/
+/* Definitions of helper functions ends ***************************************/
+/******************************************************************************/
+
+CodeGenOptions getDefaultCodeGenOptions()
+{
+    CodeGenOptions options;
+
+    options.maxCodeLength = MAX_CODE_LENGTH;
+    options.peepholePasses = PEEPHOLE_ALL;
+    options.eliminateDeadCode = 1;
+    options.inlineThreshold = DEFAULT_INLINE_THRESHOLD;
+
+    return options;
+}
+
+int compileTokenList(TokenList tokenList, CodeGenOptions options, CodeBuffer* code)
+{
+    CodeGenContext ctx;
+
+    // Parse the whole program into a tree first. Every node is made of at
+    // .. least one token, but for the blocks of empty procedures, so room
+    // .. for a node per token rarely needs to grow.
+    initAst(&ctx.ast, tokenList.numberOfTokens + 1);
+
+    int err = buildAst(tokenList, &ctx.ast);
+
+    if(err)
+    {
+        deleteAst(&ctx.ast);
+        return err;
+    }
+
+    // Initialize current level to 0, which is the global level
+    ctx.currentLevel = 0;
+    ctx.tokens = tokenList.tokens;
+    ctx.blockName = "";
+
+    // The buffer the emitted code will be written, up to the maximum length
+    initCodeBuffer(&ctx.code, options.maxCodeLength);
+
+    // The procedure addresses and the expression tree pool, with room for a
+    // .. node per AST node
+    size_t numberOfNodes = (size_t)ctx.ast.numberOfNodes + 1;
+
+    ctx.procAddresses = (int*)malloc(numberOfNodes * sizeof(int));
+    ctx.isCalled = (char*)malloc(numberOfNodes);
+    ctx.isInlinable = (char*)malloc(numberOfNodes);
+    ctx.inlinedAddresses = (int*)malloc(numberOfNodes * sizeof(int));
+    ctx.exprNodes = (ExprNode*)malloc((numberOfNodes + 1) * sizeof(ExprNode));
+    ctx.numberOfExprNodes = 0;
+    ctx.exprNodeCapacity = (int)numberOfNodes;
+    ctx.exprNodesOverflowed = 0;
+
+    if(!ctx.procAddresses || !ctx.isCalled || !ctx.isInlinable || !ctx.inlinedAddresses || !ctx.exprNodes)
+    {
+        // Reported as a program too large to be compiled
+        fprintf(stderr, "Could not allocate space for the expression trees.\n");
+        free(ctx.procAddresses);
+        free(ctx.isCalled);
+        free(ctx.isInlinable);
+        free(ctx.inlinedAddresses);
+        free(ctx.exprNodes);
+        deleteAst(&ctx.ast);
+        return 20;
+    }
+
+    // Without the call graph, every procedure is compiled
+    ctx.eliminateDeadCode = options.eliminateDeadCode && !markCalledProcedures(&ctx.ast, ctx.isCalled);
+
+    for(size_t i = 0; i < numberOfNodes; i++)
+        ctx.inlinedAddresses[i] = -1;
+
+    findInlinableProcedures(&ctx, options.inlineThreshold);
+
+    // The layout of the activation record is set up by block()
+    ctx.numberOfVariables = 0;
+    ctx.spillDepth = 0;
+    ctx.frameSize = 0;
+
+    // Walk the tree from the main block
+    program(&ctx);
+
+    if(ctx.code.overflowed || ctx.exprNodesOverflowed)
+    {
+        err = 20;
+    }
+    else
+    {
+        if(ctx.eliminateDeadCode)
+            removeUnreachableBlocks(&ctx.code);
+
+        optimizeCode(&ctx.code, options.peepholePasses);
+    }
+
+    free(ctx.procAddresses);
+    free(ctx.isCalled);
+    free(ctx.isInlinable);
+    free(ctx.inlinedAddresses);
+    free(ctx.exprNodes);
+    deleteAst(&ctx.ast);
+
+    // Hand the emitted code over to the caller - if no error occured
+    if(!err && code)
+        *code = ctx.code;
+    else
+        deleteCodeBuffer(&ctx.code);
+
+    return err;
+}
+
+/**
+ * Advertised codeGenerator function. Given token list, which is possibly the
+ * output of the lexer, parses a program out of tokens and generates code.
+ * If encountered, returns the error code.
+ *
+ * Returning 0 signals successful code generation.
+ * Otherwise, returns a non-zero code generator error code.
+ * */
+int codeGenerator(TokenList tokenList, FILE* out, CodeGenOptions options)
+{
+    CodeBuffer code;
+
+    int err = compileTokenList(tokenList, options, &code);
+
+    // Print the emitted codes to the file - if no error occured
+    if(!err)
+    {
+        printCodeBuffer(&code, out);
+        deleteCodeBuffer(&code);
+    }
+
+    // Return err code - which is 0 if parsing was successful
+    return err;
+}
+
+
+void program(CodeGenContext* ctx)
+{
+    // Generate code for the main block
+    block(ctx, ctx->ast.root);
+
+    // End of program, emit halt code
+    emit(ctx, SIO_HALT, 0, 0, 3);
+}
+
+void block(CodeGenContext* ctx, int node)
+{
+    const AstNode* n = getNode(ctx, node);
+    int declarations = n->first;
+    int body = n->second;
+
+    // The activation record layout of the enclosing block, if any
+    unsigned int outerLevel = ctx->currentLevel;
+    int outerNumberOfVariables = ctx->numberOfVariables;
+    int outerSpillDepth = ctx->spillDepth;
+    int outerFrameSize = ctx->frameSize;
+
+    ctx->currentLevel = n->level;
+    ctx->numberOfVariables = n->value;
+    ctx->spillDepth = 0;
+    ctx->frameSize = AR_VARIABLE_OFFSET + n->value;
+
+    // Reserve the activation record. Its size is known once the whole block
+    // .. is compiled, so it is patched at the end.
+    int inc = emit(ctx, INC, 0, 0, AR_VARIABLE_OFFSET);
+
+    // Constants and variables need no code
+    proc_declaration(ctx, declarations);
+    statement(ctx, body);
+
+    patchInstruction(&ctx->code, inc, ctx->frameSize);
+
+    ctx->currentLevel = outerLevel;
+    ctx->numberOfVariables = outerNumberOfVariables;
+    ctx->spillDepth = outerSpillDepth;
+    ctx->frameSize = outerFrameSize;
+}
+
+void proc_declaration(CodeGenContext* ctx, int declarations)
+{
+    int jmp = -1;
+
+    for(int node = declarations; node >= 0; node = getNode(ctx, node)->next)
+    {
+        if(getNode(ctx, node)->kind != AST_PROC)
+            continue;
+
+        // Inlined procedures are never called
+        if(ctx->isInlinable[node] || (ctx->eliminateDeadCode && !ctx->isCalled[node]))
+            continue;
+
+        // Jump over the procedures to the statement of the block
+        if(jmp < 0)
+            jmp = emit(ctx, JMP, 0, 0, 0);
+
+        ctx->procAddresses[node] = ctx->code.numberOfInstructions;
+
+        const char* outerBlockName = ctx->blockName;
+        ctx->blockName = ctx->tokens[getNode(ctx, node)->value].lexeme;
+        addCodeLabel(&ctx->code, ctx->blockName);
+
+        block(ctx, getNode(ctx, node)->first);
+        emit(ctx, RTN, 0, 0, 0);
+
+        ctx->blockName = outerBlockName;
+    }
+
+    if(jmp >= 0)
+    {
+        patchInstruction(&ctx->code, jmp, ctx->code.numberOfInstructions);
+
+        // The statement of the block follows the code of its procedures
+        addCodeLabel(&ctx->code, ctx->blockName);
+    }
+}
+
+void statement(CodeGenContext* ctx, int node)
+{
+    int jmp, jmp2, condition, l, m;
+
+    // Empty statement
+    if(node < 0)
+        return;
+
+    // The expression trees of the enclosing statements have all been emitted
+    // .. by now, so their nodes are released. Inlined bodies are compiled
+    // .. once per call site, and would otherwise keep adding nodes.
+    ctx->numberOfExprNodes = 0;
+
+    const AstNode* n = getNode(ctx, node);
+    const AstNode* declaration;
+
+    switch(n->kind)
+    {
+    case AST_ASSIGN:
+        variableAddress(ctx, n->value, &l, &m);
+
+        compileExpression(ctx, expression(ctx, n->first), 0);
+        emit(ctx, STO, 0, l, m);
+        break;
+
+    case AST_CALL:
+        if(ctx->isInlinable[n->value])
+        {
+            inlineProcedure(ctx, n->value);
+            break;
+        }
+
+        declaration = getNode(ctx, n->value);
+
+        emit(ctx, CAL, 0, ctx->currentLevel - declaration->level, ctx->procAddresses[n->value]);
+        break;
+
+    case AST_BEGIN:
+        for(int s = n->first; s >= 0; s = getNode(ctx, s)->next)
+            statement(ctx, s);
+        break;
+
+    case AST_IF:
+        condition = expression(ctx, n->first);
+
+        // Only the branch taken is compiled if the condition is constant
+        if(ctx->eliminateDeadCode && ctx->exprNodes[condition].op == LIT)
+        {
+            statement(ctx, ctx->exprNodes[condition].m ? n->second : n->third);
+            break;
+        }
+
+        compileExpression(ctx, condition, 0);
+        jmp = emit(ctx, JPC, 0, 0, 0);
+
+        statement(ctx, n->second);
+
+        if(n->third >= 0)
+        {
+            // The then branch jumps over the else branch, which is where
+            // .. the condition jumps to when false
+            jmp2 = emit(ctx, JMP, 0, 0, 0);
+            patchInstruction(&ctx->code, jmp, ctx->code.numberOfInstructions);
+
+            statement(ctx, n->third);
+
+            patchInstruction(&ctx->code, jmp2, ctx->code.numberOfInstructions);
+        }
+        else
+        {
+            patchInstruction(&ctx->code, jmp, ctx->code.numberOfInstructions);
+        }
+        break;
+
+    case AST_WHILE:
+        jmp = ctx->code.numberOfInstructions;
+        condition = expression(ctx, n->first);
+
+        // A constant false condition skips the loop, a constant true one
+        // .. needs no test
+        if(ctx->eliminateDeadCode && ctx->exprNodes[condition].op == LIT)
+        {
+            if(ctx->exprNodes[condition].m)
+            {
+                statement(ctx, n->second);
+                emit(ctx, JMP, 0, 0, jmp);
+            }
+            break;
+        }
+
+        compileExpression(ctx, condition, 0);
+        jmp2 = emit(ctx, JPC, 0, 0, 0);
+
+        statement(ctx, n->second);
+
+        emit(ctx, JMP, 0, 0, jmp);
+        patchInstruction(&ctx->code, jmp2, ctx->code.numberOfInstructions);
+        break;
+
+    case AST_WRITE:
+        compileExpression(ctx, expression(ctx, n->first), 0);
+        emit(ctx, SIO_WRITE, 0, 0, 0);
+        break;
+
+    case AST_READ:
+        variableAddress(ctx, n->value, &l, &m);
+
+        emit(ctx, SIO_READ, 0, 0, 0);
+        emit(ctx, STO, 0, l, m);
+        break;
+    }
+}
+
+void variableAddress(CodeGenContext* ctx, int declaration, int* l, int* m)
+{
+    const AstNode* variable = getNode(ctx, declaration);
+
+    if(ctx->inlinedAddresses[declaration] >= 0)
+    {
+        *l = 0;
+        *m = ctx->inlinedAddresses[declaration];
+    }
+    else
+    {
+        *l = ctx->currentLevel - variable->level;
+        *m = variable->value;
+    }
+}
+
+/**
+ * Returns the number of AST nodes of the given statement or expression, and
+ * .. the statements chained after it, counting no further than limit + 1.
+ * */
+static int countNodes(CodeGenContext* ctx, int node, int limit)
+{
+    int count = 0;
+
+    for(; node >= 0 && count <= limit; node = getNode(ctx, node)->next)
+    {
+        const AstNode* n = getNode(ctx, node);
+
+        count++;
+
+        // Only statements and expressions are counted, whose children are
+        // .. all statements and expressions. AST_ASSIGN, AST_CALL and
+        // .. AST_READ refer to declarations through value.
+        count += countNodes(ctx, n->first, limit - count);
+        count += countNodes(ctx, n->second, limit - count);
+        count += countNodes(ctx, n->third, limit - count);
+    }
+
+    return count;
+}
+
+void findInlinableProcedures(CodeGenContext* ctx, int threshold)
+{
+    memset(ctx->isInlinable, 0, (size_t)ctx->ast.numberOfNodes + 1);
+
+    if(threshold <= 0)
+        return;
+
+    // Without the call graph, no procedure is known not to be recursive
+    char* isRecursive = (char*)malloc((size_t)ctx->ast.numberOfNodes + 1);
+
+    if(!isRecursive || markRecursiveProcedures(&ctx->ast, isRecursive))
+    {
+        free(isRecursive);
+        return;
+    }
+
+    for(int proc = 0; proc < ctx->ast.numberOfNodes; proc++)
+    {
+        if(getNode(ctx, proc)->kind != AST_PROC || isRecursive[proc])
+            continue;
+
+        const AstNode* b = getNode(ctx, getNode(ctx, proc)->first);
+
+        // The procedures it declares would need its activation record
+        int declaresProcedures = 0;
+        for(int d = b->first; d >= 0; d = getNode(ctx, d)->next)
+            declaresProcedures |= getNode(ctx, d)->kind == AST_PROC;
+
+        if(!declaresProcedures && countNodes(ctx, b->second, threshold) <= threshold)
+            ctx->isInlinable[proc] = 1;
+    }
+
+    free(isRecursive);
+}
+
+void inlineProcedure(CodeGenContext* ctx, int proc)
+{
+    const AstNode* b = getNode(ctx, getNode(ctx, proc)->first);
+    int outerNumberOfVariables = ctx->numberOfVariables;
+
+    // The variables of the procedure follow those of the block, in the
+    // .. order they have in the activation record of the procedure
+    for(int d = b->first; d >= 0; d = getNode(ctx, d)->next)
+    {
+        if(getNode(ctx, d)->kind == AST_VAR)
+            ctx->inlinedAddresses[d] = getNode(ctx, d)->value + outerNumberOfVariables;
+    }
+
+    ctx->numberOfVariables += b->value;
+    if(AR_VARIABLE_OFFSET + ctx->numberOfVariables > ctx->frameSize)
+        ctx->frameSize = AR_VARIABLE_OFFSET + ctx->numberOfVariables;
+
+    statement(ctx, b->second);
+
+    ctx->numberOfVariables = outerNumberOfVariables;
+
+    for(int d = b->first; d >= 0; d = getNode(ctx, d)->next)
+        ctx->inlinedAddresses[d] = -1;
+}
+
+int expression(CodeGenContext* ctx, int node)
+{
+    const AstNode* n = getNode(ctx, node);
+    int left, l, m;
+
+    switch(n->kind)
+    {
+    case AST_NUMBER:
+        return newExprNode(ctx, LIT, 0, n->value, -1, -1);
+
+    case AST_IDENT:
+        if(getNode(ctx, n->value)->kind == AST_CONST)
+            return newExprNode(ctx, LIT, 0, getNode(ctx, n->value)->value, -1, -1);
+
+        variableAddress(ctx, n->value, &l, &m);
+        return newExprNode(ctx, LOD, l, m, -1, -1);
+
+    case AST_UNARY:
+        return foldExprNode(ctx, n->op, expression(ctx, n->first), -1);
+
+    default:
+        // AST_BINARY. The left operand is built first, as in the source.
+        left = expression(ctx, n->first);
+        return foldExprNode(ctx, n->op, left, expression(ctx, n->second));
+    }
+}
@@ -2,8 +2,66 @@
 #define __CODE_GENERATOR_H__
 
 #include "token.h"
+#include "code_buffer.h"
 
-int codeGenerator(TokenList, FILE*);
+/**
+ * Options of the code generator.
+ * */
+typedef struct {
+    /**
+     * The maximum number of instructions the generated code can have. If the
+     * .. program needs more, code generation fails with error 20.
+     * */
+    int maxCodeLength;
+
+    /**
+     * The passes of the peephole optimizer run on the generated code, as a
+     * .. mask of the PEEPHOLE_* flags of peephole.h.
+     * */
+    int peepholePasses;
+
+    /**
+     * Whether dead code is removed: procedures that are never called, the
+     * .. branches of conditions known at compile time, and any other code
+     * .. the control-flow graph shows to be unreachable.
+     * */
+    int eliminateDeadCode;
+
+    /**
+     * The size, in AST nodes, of the largest procedure statement compiled
+     * .. inline at its calls. Only procedures that are not recursive and
+     * .. declare no procedures are inlined. 0 disables inlining.
+     * */
+    int inlineThreshold;
+} CodeGenOptions;
+
+/**
+ * The default inlining threshold: enough for a few short statements.
+ * */
+#define DEFAULT_INLINE_THRESHOLD 16
+
+/**
+ * Returns the default options: the code length is limited to MAX_CODE_LENGTH,
+ * .. dead code is eliminated, procedures up to DEFAULT_INLINE_THRESHOLD AST
+ * .. nodes are inlined and all the peephole passes are run.
+ * */
+CodeGenOptions getDefaultCodeGenOptions();
+
+/**
+ * Compiles the given token list into PM/0 code in memory. On success, returns
+ * .. 0 and fills the given CodeBuffer, which the caller should delete with
+ * .. deleteCodeBuffer(). Otherwise, returns the code generator error code and
+ * .. leaves the CodeBuffer untouched.
+ * All the state of a compilation is local to the call, so different token
+ * .. lists can be compiled concurrently.
+ * */
+int compileTokenList(TokenList, CodeGenOptions, CodeBuffer*);
+
+/**
+ * Compiles the given token list and prints the PM/0 code to the given file.
+ * Returns 0 on success, the code generator error code otherwise.
+ * */
+int codeGenerator(TokenList, FILE*, CodeGenOptions);
 
 void printCGErr(int errCode, FILE*);
 
@@ -0,0 +1,189 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "code_object.h"
+#include <stdlib.h>
+#include <string.h>
+
+int writeCodeObject(const CodeBuffer* code, FILE* out)
+{
+    if(!code || !out || code->numberOfInstructions < 0 || code->numberOfLabels < 0)
+        return -1;
+
+    uint32_t numberOfInstructions = (uint32_t)code->numberOfInstructions;
+    uint32_t numberOfSymbols = (uint32_t)code->numberOfLabels;
+
+    CodeObjectSymbol* symbols = (CodeObjectSymbol*)malloc((numberOfSymbols + 1) * sizeof(CodeObjectSymbol));
+    char* symbolNames = (char*)malloc((size_t)numberOfSymbols * (MAX_IDENTIFIER_LENGTH + 1) + 1);
+
+    int err = -1;
+    uint32_t symbolNamesSize = 0;
+
+    if(!symbols || !symbolNames)
+        goto cleanup;
+
+    for(uint32_t i = 0; i < numberOfSymbols; i++)
+    {
+        const CodeLabel* label = &code->labels[i];
+        size_t nameLength = strnlen(label->name, MAX_IDENTIFIER_LENGTH);
+
+        if(label->address < 0 || label->address > code->numberOfInstructions)
+            goto cleanup;
+
+        symbols[i].address = (uint32_t)label->address;
+        symbols[i].nameOffset = symbolNamesSize;
+
+        memcpy(symbolNames + symbolNamesSize, label->name, nameLength);
+        symbolNames[symbolNamesSize + nameLength] = '\0';
+        symbolNamesSize += (uint32_t)nameLength + 1;
+    }
+
+    CodeObjectHeader header;
+    memcpy(header.magic, CODE_OBJECT_MAGIC, sizeof(header.magic));
+    header.version = CODE_OBJECT_VERSION;
+    header.reserved = 0;
+    header.numberOfInstructions = numberOfInstructions;
+    header.numberOfSymbols = numberOfSymbols;
+    header.symbolNamesSize = symbolNamesSize;
+
+    if(fwrite(&header, sizeof(header), 1, out) != 1)
+        goto cleanup;
+
+    // Written field by field, so the file does not depend on the layout of
+    // .. Instruction
+    for(uint32_t i = 0; i < numberOfInstructions; i++)
+    {
+        const Instruction* ins = &code->instructions[i];
+        int32_t fields[4] = { ins->op, ins->r, ins->l, ins->m };
+
+        if(fwrite(fields, sizeof(fields), 1, out) != 1)
+            goto cleanup;
+    }
+
+    if( fwrite(symbols, sizeof(CodeObjectSymbol), numberOfSymbols, out) == numberOfSymbols &&
+        fwrite(symbolNames, 1, symbolNamesSize, out) == symbolNamesSize )
+    {
+        err = 0;
+    }
+
+cleanup:
+    free(symbols);
+    free(symbolNames);
+
+    return err;
+}
+
+int isCodeObject(FILE* in)
+{
+    if(!in) return 0;
+
+    int c = getc(in);
+
+    if(c == EOF) return 0;
+
+    ungetc(c, in);
+
+    return c == CODE_OBJECT_MAGIC[0];
+}
+
+int openCodeObject(FILE* in, CodeObject* object)
+{
+    CodeObjectHeader header;
+
+    if(!object) return -1;
+
+    memset(object, 0, sizeof(*object));
+
+    // Regular files are mapped, so the arrays below alias the file contents
+    SourceCode file = readSourceCode(in);
+
+    if(!file.text || file.length < sizeof(header))
+        goto invalid;
+
+    memcpy(&header, file.text, sizeof(header));
+
+    if(memcmp(header.magic, CODE_OBJECT_MAGIC, sizeof(header.magic)) || header.version != CODE_OBJECT_VERSION)
+        goto invalid;
+
+    // The instructions are read from the file without being copied, which
+    // .. requires Instruction to have the layout of the file and 4 byte
+    // .. alignment. Mappings and heap allocations both start aligned.
+    if(sizeof(Instruction) != 4 * sizeof(int32_t) || (uintptr_t)file.text % sizeof(int32_t))
+        goto invalid;
+
+    uint64_t expectedLength = (uint64_t)sizeof(header)
+        + (uint64_t)header.numberOfInstructions * sizeof(Instruction)
+        + (uint64_t)header.numberOfSymbols * sizeof(CodeObjectSymbol)
+        + header.symbolNamesSize;
+
+    if(expectedLength != file.length || header.numberOfInstructions > INT32_MAX)
+        goto invalid;
+
+    const char* section = file.text + sizeof(header);
+
+    object->instructions = (const Instruction*)section;
+    section += (size_t)header.numberOfInstructions * sizeof(Instruction);
+
+    object->symbols = (const CodeObjectSymbol*)section;
+    section += (size_t)header.numberOfSymbols * sizeof(CodeObjectSymbol);
+
+    object->symbolNames = section;
+
+    // Every symbol must be within the code, in order, and have a name that
+    // .. starts within the table and is null-terminated after at most
+    // .. MAX_IDENTIFIER_LENGTH characters
+    for(uint32_t i = 0; i < header.numberOfSymbols; i++)
+    {
+        const CodeObjectSymbol* symbol = &object->symbols[i];
+        uint32_t offset = symbol->nameOffset;
+
+        if( symbol->address > header.numberOfInstructions ||
+            (i > 0 && symbol->address < object->symbols[i - 1].address) ||
+            offset >= header.symbolNamesSize ||
+            !memchr(object->symbolNames + offset, '\0', header.symbolNamesSize - offset) ||
+            strlen(object->symbolNames + offset) > MAX_IDENTIFIER_LENGTH )
+        {
+            goto invalid;
+        }
+    }
+
+    object->numberOfInstructions = (int)header.numberOfInstructions;
+    object->numberOfSymbols = (int)header.numberOfSymbols;
+    object->file = file;
+
+    return 0;
+
+invalid:
+    deleteSourceCode(&file);
+    memset(object, 0, sizeof(*object));
+
+    return -1;
+}
+
+const char* findCodeObjectSymbol(const CodeObject* object, int address)
+{
+    if(!object || address < 0 || address >= object->numberOfInstructions)
+        return NULL;
+
+    // The last symbol at or before the address
+    int low = 0, high = object->numberOfSymbols;
+
+    while(low < high)
+    {
+        int middle = low + (high - low) / 2;
+
+        if(object->symbols[middle].address <= (uint32_t)address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low > 0 ? object->symbolNames + object->symbols[low - 1].nameOffset : NULL;
+}
+
+void closeCodeObject(CodeObject* object)
+{
+    if(!object) return;
+
+    deleteSourceCode(&object->file);
+    memset(object, 0, sizeof(*object));
+}
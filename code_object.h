@@ -0,0 +1,93 @@
+#ifndef __CODE_OBJECT_H__
+#define __CODE_OBJECT_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "code_buffer.h"
+#include "source_code.h"
+
+/**
+ * Binary PM/0 object: a compact alternative to the "op r l m" lines written
+ * .. by printCodeBuffer(), which the VM loads without parsing. The file
+ * .. consists of, in order:
+ *   - CodeObjectHeader
+ *   - int32_t instructions[numberOfInstructions][4]: the op, r, l and m
+ *     .. fields of each instruction
+ *   - CodeObjectSymbol symbols[numberOfSymbols]: the labels of the code (see
+ *     .. CodeLabel), in the order of their addresses
+ *   - char symbolNames[symbolNamesSize]: null-terminated names
+ * The symbols are debug information only; a file may have none.
+ * Integers are stored in the byte order of the machine that wrote the file.
+ * */
+
+#define CODE_OBJECT_MAGIC "PM0O"
+#define CODE_OBJECT_VERSION 1
+
+typedef struct {
+    char magic[4];            // CODE_OBJECT_MAGIC, not null-terminated
+    uint16_t version;         // CODE_OBJECT_VERSION
+    uint16_t reserved;        // 0
+    uint32_t numberOfInstructions;
+    uint32_t numberOfSymbols;
+    uint32_t symbolNamesSize; // in bytes
+} CodeObjectHeader;
+
+typedef struct {
+    uint32_t address;    // at most numberOfInstructions
+    uint32_t nameOffset; // the start of the name in symbolNames
+} CodeObjectSymbol;
+
+/**
+ * A read-only view of a binary PM/0 object. The arrays point directly into
+ * .. the file contents, which are memory mapped for regular files, so the
+ * .. instructions are loaded without being copied or parsed. The VM still
+ * .. decodes them into its own threaded code before running them.
+ * */
+typedef struct {
+    int numberOfInstructions;
+    const Instruction* instructions;
+    int numberOfSymbols;
+    const CodeObjectSymbol* symbols;
+    const char* symbolNames;
+    SourceCode file; // the storage of the file contents
+} CodeObject;
+
+/**
+ * Writes the code and the labels of the given CodeBuffer to the given FILE
+ * .. as a binary PM/0 object.
+ * Returns 0 on success, -1 if the object could not be written.
+ * */
+int writeCodeObject(const CodeBuffer*, FILE*);
+
+/**
+ * Returns whether the given FILE starts with CODE_OBJECT_MAGIC at its current
+ * .. position, which is left unchanged. Text code always starts with a digit
+ * .. or a space, so the formats can be told apart from the first character.
+ * */
+int isCodeObject(FILE*);
+
+/**
+ * Opens the binary PM/0 object in the given FILE, from its current position
+ * .. until EOF, and validates its layout: the sizes of the sections match
+ * .. the size of the file, and every symbol is within the code and has a
+ * .. null-terminated name of at most MAX_IDENTIFIER_LENGTH characters. The
+ * .. fields of the instructions are checked by the VM as it executes them,
+ * .. just as for text code.
+ * Returns 0 on success. Returns -1 if the file is not a valid object, in
+ * .. which case the object is left empty.
+ * */
+int openCodeObject(FILE*, CodeObject*);
+
+/**
+ * Returns the name of the symbol the instruction at the given address belongs
+ * .. to, which is the last symbol at or before it. Returns NULL if there is
+ * .. none, or if the address is outside the code.
+ * */
+const char* findCodeObjectSymbol(const CodeObject*, int address);
+
+/**
+ * Releases the storage of the object and resets it to empty.
+ * */
+void closeCodeObject(CodeObject*);
+
+#endif
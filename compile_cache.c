@@ -0,0 +1,149 @@
+#define _POSIX_C_SOURCE 200809L
+#include "compile_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+/**
+ * The first line of a cache entry, followed by the stored output:
+ * .. "PL0C <version> <check> <outputLength>\n"
+ * */
+#define COMPILE_CACHE_MAGIC "PL0C"
+
+/**
+ * The longest path of a cache entry.
+ * */
+#define COMPILE_CACHE_PATH_LENGTH 4096
+
+/**
+ * FNV-1a, continued from the given hash.
+ * */
+static uint64_t hashFNV1a(uint64_t hash, const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * A multiply-xorshift hash, continued from the given hash. Independent
+ * .. enough of FNV-1a that a collision of both is out of reach.
+ * */
+static uint64_t hashMix(uint64_t hash, const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    for(size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+
+    return hash;
+}
+
+CompileKey getCompileKey(const char* input, size_t length, CompileInputKind kind, CodeGenOptions options)
+{
+    // Everything the output depends on besides the input itself
+    char header[128];
+    int headerLength = snprintf(header, sizeof(header), "%d %d %d %d %d %d %zu\n",
+        COMPILE_CACHE_VERSION, (int)kind, options.maxCodeLength, options.peepholePasses,
+        options.eliminateDeadCode, options.inlineThreshold, length);
+
+    CompileKey key;
+
+    key.hash = hashFNV1a(0xcbf29ce484222325ULL, header, (size_t)headerLength);
+    key.hash = hashFNV1a(key.hash, input, length);
+
+    key.check = hashMix(0x243f6a8885a308d3ULL, header, (size_t)headerLength);
+    key.check = hashMix(key.check, input, length);
+
+    return key;
+}
+
+/**
+ * Writes the path of the entry of the given key to path.
+ * Returns 0 on success, -1 if it does not fit.
+ * */
+static int getEntryPath(char* path, const char* directory, CompileKey key)
+{
+    int length = snprintf(path, COMPILE_CACHE_PATH_LENGTH, "%s/%016" PRIx64, directory, key.hash);
+
+    return length > 0 && length < COMPILE_CACHE_PATH_LENGTH ? 0 : -1;
+}
+
+int lookupCompileCache(const char* directory, CompileKey key, char** output, size_t* outputLength)
+{
+    char path[COMPILE_CACHE_PATH_LENGTH];
+
+    if(getEntryPath(path, directory, key)) return -1;
+
+    FILE* fp = fopen(path, "rb");
+
+    if(!fp) return -1;
+
+    int version;
+    uint64_t check;
+    size_t length;
+    char* stored = NULL;
+
+    int result = -1;
+
+    if(fscanf(fp, COMPILE_CACHE_MAGIC " %d %" SCNx64 " %zu", &version, &check, &length) == 3 &&
+       fgetc(fp) == '\n' && version == COMPILE_CACHE_VERSION && check == key.check &&
+       (stored = (char*)malloc(length + 1)) != NULL &&
+       fread(stored, 1, length, fp) == length)
+    {
+        stored[length] = '\0';
+
+        *output = stored;
+        *outputLength = length;
+        result = 0;
+    }
+    else
+    {
+        free(stored);
+    }
+
+    fclose(fp);
+
+    return result;
+}
+
+int storeCompileCache(const char* directory, CompileKey key, const char* output, size_t outputLength)
+{
+    char path[COMPILE_CACHE_PATH_LENGTH];
+    char temporaryPath[COMPILE_CACHE_PATH_LENGTH + 64];
+
+    if(getEntryPath(path, directory, key)) return -1;
+
+    // Unique among the writers of the same entry: they may be different
+    // .. processes or different threads
+    static int counter = 0;
+    int id = __sync_fetch_and_add(&counter, 1);
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.%ld.%d.tmp", path, (long)getpid(), id);
+
+    FILE* fp = fopen(temporaryPath, "wb");
+
+    if(!fp) return -1;
+
+    int written =
+        fprintf(fp, COMPILE_CACHE_MAGIC " %d %016" PRIx64 " %zu\n", COMPILE_CACHE_VERSION, key.check, outputLength) > 0 &&
+        fwrite(output, 1, outputLength, fp) == outputLength;
+
+    if(fclose(fp) || !written || rename(temporaryPath, path))
+    {
+        remove(temporaryPath);
+        return -1;
+    }
+
+    return 0;
+}
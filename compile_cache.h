@@ -0,0 +1,58 @@
+#ifndef __COMPILE_CACHE_H__
+#define __COMPILE_CACHE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "code_generator.h"
+
+/**
+ * The version of the compiler output. Cached outputs of other versions are
+ * .. ignored, so it has to be bumped whenever a change to the code generator
+ * .. or its optimizations can change the code or the errors it produces for
+ * .. some input, including fixes of its crashes.
+ * */
+#define COMPILE_CACHE_VERSION 2
+
+/**
+ * The kinds of input a compilation starts from.
+ * COMPILE_INPUT_TOKENS        : a token table, as printTokenList() writes it
+ * COMPILE_INPUT_BINARY_TOKENS : a binary token stream (see token_stream.h)
+ * COMPILE_INPUT_SOURCE        : PL/0 source code
+ * */
+typedef enum {
+    COMPILE_INPUT_TOKENS,
+    COMPILE_INPUT_BINARY_TOKENS,
+    COMPILE_INPUT_SOURCE
+} CompileInputKind;
+
+/**
+ * The content address of a compilation: two independent 64-bit hashes of
+ * .. the input, its kind, the code generator options and the version. The
+ * .. first names the cache entry, the second is checked when it is read.
+ * */
+typedef struct {
+    uint64_t hash;
+    uint64_t check;
+} CompileKey;
+
+/**
+ * Returns the key of compiling the given input with the given options.
+ * */
+CompileKey getCompileKey(const char* input, size_t length, CompileInputKind, CodeGenOptions);
+
+/**
+ * Looks the given key up in the cache directory. On a hit, returns 0 and
+ * .. sets output to a new allocation, which the caller should free, holding
+ * .. the outputLength bytes that were stored. Returns -1 on a miss.
+ * */
+int lookupCompileCache(const char* directory, CompileKey, char** output, size_t* outputLength);
+
+/**
+ * Stores the given output under the given key in the cache directory, which
+ * .. has to exist. The entry is written to a temporary file and renamed into
+ * .. place, so concurrent readers and writers never see a partial entry.
+ * Returns 0 on success, -1 if the entry could not be written.
+ * */
+int storeCompileCache(const char* directory, CompileKey, const char* output, size_t outputLength);
+
+#endif
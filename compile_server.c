@@ -0,0 +1,523 @@
+#define _POSIX_C_SOURCE 200809L
+#include "compile_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "token.h"
+#include "token_stream.h"
+#include "source_code.h"
+#include "lexical_analyzer.h"
+
+/**
+ * The longest request or response line, including the newline.
+ * */
+#define COMPILE_SERVER_LINE_LENGTH 256
+
+/* ************************************************************************** */
+/* Compilation ************************************************************** */
+/* ************************************************************************** */
+
+/**
+ * Reads the token list of a token table or a binary token stream held in
+ * .. memory.
+ * */
+static TokenList readTokensFromMemory(const char* input, size_t length, CompileInputKind kind)
+{
+    TokenList tokenList;
+
+    // fmemopen() does not accept an empty buffer
+    FILE* fp = length ? fmemopen((void*)input, length, "r") : NULL;
+
+    if(!fp)
+    {
+        initTokenList(&tokenList);
+        return tokenList;
+    }
+
+    tokenList = kind == COMPILE_INPUT_BINARY_TOKENS ? readTokenStream(fp) : readTokenList(fp);
+    fclose(fp);
+
+    return tokenList;
+}
+
+int compileInput(const char* input, size_t length, CompileInputKind kind, CodeGenOptions options, CompileResult* result)
+{
+    result->cached = 0;
+    result->isError = 1;
+    result->output = NULL;
+    result->outputLength = 0;
+
+    FILE* outp = open_memstream(&result->output, &result->outputLength);
+
+    if(!outp) return -1;
+
+    TokenList tokenList;
+
+    if(kind == COMPILE_INPUT_SOURCE)
+    {
+        // A view of the input: it is not owned, so it is not deleted
+        SourceCode sourceCode = { length ? input : NULL, length, NULL, 0 };
+        LexerOut lexerOut = lexicalAnalyzer(sourceCode);
+
+        if(lexerOut.lexerError != NONE)
+        {
+            printLexErr(lexerOut.lexerError, lexerOut.errorLine, outp);
+            deleteLexerOut(&lexerOut);
+            goto done;
+        }
+
+        tokenList = lexerOut.tokenList;
+    }
+    else
+    {
+        tokenList = readTokensFromMemory(input, length, kind);
+    }
+
+    CodeBuffer code;
+    int err = compileTokenList(tokenList, options, &code);
+
+    if(err)
+    {
+        printCGErr(err, outp);
+    }
+    else
+    {
+        printCodeBuffer(&code, outp);
+        deleteCodeBuffer(&code);
+        result->isError = 0;
+    }
+
+    deleteTokenList(&tokenList);
+
+done:
+    if(fclose(outp))
+    {
+        deleteCompileResult(result);
+        return -1;
+    }
+
+    return 0;
+}
+
+int compileWithCache(const char* cacheDirectory, const char* input, size_t length, CompileInputKind kind, CodeGenOptions options, CompileResult* result)
+{
+    CompileKey key = getCompileKey(input, length, kind, options);
+
+    // The first byte of an entry records whether the output is an error
+    char* entry;
+    size_t entryLength;
+
+    if(!lookupCompileCache(cacheDirectory, key, &entry, &entryLength))
+    {
+        if(entryLength > 0 && (entry[0] == 'C' || entry[0] == 'E'))
+        {
+            result->cached = 1;
+            result->isError = entry[0] == 'E';
+            result->outputLength = entryLength - 1;
+            result->output = entry;
+
+            memmove(entry, entry + 1, entryLength);
+
+            return 0;
+        }
+
+        free(entry);
+    }
+
+    if(compileInput(input, length, kind, options, result))
+        return -1;
+
+    entry = (char*)malloc(result->outputLength + 1);
+
+    // The output is served even if it cannot be cached
+    if(entry)
+    {
+        entry[0] = result->isError ? 'E' : 'C';
+        memcpy(entry + 1, result->output, result->outputLength);
+
+        storeCompileCache(cacheDirectory, key, entry, result->outputLength + 1);
+        free(entry);
+    }
+
+    return 0;
+}
+
+void deleteCompileResult(CompileResult* result)
+{
+    if(!result) return;
+
+    free(result->output);
+
+    result->output = NULL;
+    result->outputLength = 0;
+}
+
+/* ************************************************************************** */
+/* Protocol ***************************************************************** */
+/* ************************************************************************** */
+
+/**
+ * Writes all the given bytes to the socket. Returns 0 on success, -1 if the
+ * .. connection failed. A peer that hung up is reported as a failure rather
+ * .. than a SIGPIPE, without changing the signal handling of the process.
+ * */
+static int writeFully(int fd, const char* data, size_t length)
+{
+    while(length)
+    {
+        ssize_t written = send(fd, data, length, MSG_NOSIGNAL);
+
+        if(written < 0 && errno == EINTR) continue;
+        if(written <= 0) return -1;
+
+        data += written;
+        length -= (size_t)written;
+    }
+
+    return 0;
+}
+
+/**
+ * Reads exactly the given number of bytes from the socket. Returns 0 on
+ * .. success, -1 if the connection failed or was closed before.
+ * */
+static int readFully(int fd, char* data, size_t length)
+{
+    while(length)
+    {
+        ssize_t count = read(fd, data, length);
+
+        if(count < 0 && errno == EINTR) continue;
+        if(count <= 0) return -1;
+
+        data += count;
+        length -= (size_t)count;
+    }
+
+    return 0;
+}
+
+/**
+ * Reads a line from the socket, one byte at a time so that nothing past the
+ * .. newline is consumed, and null-terminates it without the newline.
+ * Returns 0 on success, -1 if the connection failed or the line is longer
+ * .. than COMPILE_SERVER_LINE_LENGTH.
+ * */
+static int readLine(int fd, char* line)
+{
+    for(int i = 0; i < COMPILE_SERVER_LINE_LENGTH; i++)
+    {
+        if(readFully(fd, &line[i], 1)) return -1;
+
+        if(line[i] == '\n')
+        {
+            line[i] = '\0';
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Fills the given address with the socket path. Returns 0 on success, -1 if
+ * .. the path is too long for a socket address.
+ * */
+static int getSocketAddress(struct sockaddr_un* address, const char* socketPath)
+{
+    if(strlen(socketPath) >= sizeof(address->sun_path)) return -1;
+
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socketPath);
+
+    return 0;
+}
+
+/**
+ * Returns a socket connected to the server listening on the given path, -1
+ * .. if there is none.
+ * */
+static int connectToServer(const char* socketPath)
+{
+    struct sockaddr_un address;
+
+    if(getSocketAddress(&address, socketPath)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(fd < 0) return -1;
+
+    if(connect(fd, (struct sockaddr*)&address, sizeof(address)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int requestCompilation(const char* socketPath, const char* input, size_t length, CompileInputKind kind, CodeGenOptions options, CompileResult* result)
+{
+    char line[COMPILE_SERVER_LINE_LENGTH + 1];
+
+    result->output = NULL;
+    result->outputLength = 0;
+
+    int fd = connectToServer(socketPath);
+
+    if(fd < 0) return -1;
+
+    int lineLength = snprintf(line, sizeof(line), "PL0 %d %zu %d %d %d %d\n", (int)kind, length,
+        options.maxCodeLength, options.peepholePasses, options.eliminateDeadCode, options.inlineThreshold);
+
+    char status[16], outcome[16];
+    size_t outputLength;
+
+    int failed =
+        writeFully(fd, line, (size_t)lineLength) ||
+        writeFully(fd, input, length) ||
+        readLine(fd, line) ||
+        sscanf(line, "%15s %15s %zu", status, outcome, &outputLength) != 3 ||
+        !strcmp(status, "failed") ||
+        outputLength > COMPILE_SERVER_MAX_INPUT_LENGTH ||
+        !(result->output = (char*)malloc(outputLength + 1)) ||
+        readFully(fd, result->output, outputLength);
+
+    close(fd);
+
+    if(failed)
+    {
+        deleteCompileResult(result);
+        return -1;
+    }
+
+    result->output[outputLength] = '\0';
+    result->outputLength = outputLength;
+    result->cached = !strcmp(status, "cached");
+    result->isError = !strcmp(outcome, "error");
+
+    return 0;
+}
+
+/* ************************************************************************** */
+/* Server ******************************************************************* */
+/* ************************************************************************** */
+
+/**
+ * Set by the SIGINT and SIGTERM handler to stop the server.
+ * */
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int signalNumber)
+{
+    (void)signalNumber;
+    stopRequested = 1;
+}
+
+/**
+ * The number of compilations served, and how many came from the cache.
+ * */
+static int servedCount = 0;
+static int cachedCount = 0;
+
+/**
+ * The connections that can still be served at the same time, up to
+ * .. COMPILE_SERVER_MAX_CONNECTIONS. Taken before a connection is accepted
+ * .. and given back once it is closed.
+ * */
+static sem_t connectionSlots;
+
+typedef struct {
+    int fd;
+    const char* cacheDirectory;
+} Connection;
+
+/**
+ * Answers the given connection with a failure carrying the given message.
+ * */
+static void sendFailure(int fd, const char* message)
+{
+    char line[COMPILE_SERVER_LINE_LENGTH];
+    int lineLength = snprintf(line, sizeof(line), "failed error %zu\n", strlen(message));
+
+    if(!writeFully(fd, line, (size_t)lineLength))
+        writeFully(fd, message, strlen(message));
+}
+
+/**
+ * Serves the compilation requested on the given connection, closes it and
+ * .. gives its slot back.
+ * */
+static void* serveConnection(void* arg)
+{
+    Connection connection = *(Connection*)arg;
+    free(arg);
+
+    // A client that stalls is dropped rather than holding the connection
+    struct timeval timeout = { COMPILE_SERVER_TIMEOUT, 0 };
+    setsockopt(connection.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(connection.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char line[COMPILE_SERVER_LINE_LENGTH + 1];
+    int kind;
+    size_t length;
+    CodeGenOptions options = getDefaultCodeGenOptions();
+
+    char* input = NULL;
+
+    if(readLine(connection.fd, line) ||
+       sscanf(line, "PL0 %d %zu %d %d %d %d", &kind, &length, &options.maxCodeLength, &options.peepholePasses,
+              &options.eliminateDeadCode, &options.inlineThreshold) != 6 ||
+       kind < COMPILE_INPUT_TOKENS || kind > COMPILE_INPUT_SOURCE ||
+       length > COMPILE_SERVER_MAX_INPUT_LENGTH || options.maxCodeLength <= 0 || options.inlineThreshold < 0)
+    {
+        sendFailure(connection.fd, "Malformed request.\n");
+        goto cleanup;
+    }
+
+    if( !(input = (char*)malloc(length + 1)) )
+    {
+        sendFailure(connection.fd, "Could not allocate space for the input.\n");
+        goto cleanup;
+    }
+
+    if(readFully(connection.fd, input, length))
+        goto cleanup;
+
+    CompileResult result;
+
+    if(compileWithCache(connection.cacheDirectory, input, length, (CompileInputKind)kind, options, &result))
+    {
+        sendFailure(connection.fd, "Could not allocate space for the output.\n");
+        goto cleanup;
+    }
+
+    int lineLength = snprintf(line, sizeof(line), "%s %s %zu\n", result.cached ? "cached" : "compiled",
+        result.isError ? "error" : "code", result.outputLength);
+
+    if(!writeFully(connection.fd, line, (size_t)lineLength))
+        writeFully(connection.fd, result.output, result.outputLength);
+
+    __sync_fetch_and_add(&servedCount, 1);
+    if(result.cached) __sync_fetch_and_add(&cachedCount, 1);
+
+    deleteCompileResult(&result);
+
+cleanup:
+    free(input);
+    close(connection.fd);
+    sem_post(&connectionSlots);
+
+    return NULL;
+}
+
+int serveCompilations(const char* socketPath, const char* cacheDirectory)
+{
+    struct sockaddr_un address;
+
+    if(getSocketAddress(&address, socketPath))
+    {
+        fprintf(stderr, "The socket path \"%s\" is too long.\n", socketPath);
+        return -1;
+    }
+
+    // A socket left behind by a server that is gone is replaced; one that
+    // .. is still served is not
+    int other = connectToServer(socketPath);
+
+    if(other >= 0)
+    {
+        close(other);
+        fprintf(stderr, "Another server is listening on \"%s\".\n", socketPath);
+        return -1;
+    }
+
+    struct stat socketStat;
+    if(!stat(socketPath, &socketStat) && S_ISSOCK(socketStat.st_mode))
+        unlink(socketPath);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) || listen(listener, 64))
+    {
+        fprintf(stderr, "Could not listen on \"%s\": %s\n", socketPath, strerror(errno));
+        if(listener >= 0) close(listener);
+        return -1;
+    }
+
+    // The handler is installed without SA_RESTART, so that it interrupts
+    // .. accept()
+    struct sigaction stopAction;
+    memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = requestStop;
+    sigemptyset(&stopAction.sa_mask);
+
+    sigaction(SIGINT, &stopAction, NULL);
+    sigaction(SIGTERM, &stopAction, NULL);
+
+    pthread_attr_t detached;
+    pthread_attr_init(&detached);
+    pthread_attr_setdetachstate(&detached, PTHREAD_CREATE_DETACHED);
+
+    sem_init(&connectionSlots, 0, COMPILE_SERVER_MAX_CONNECTIONS);
+
+    while(!stopRequested)
+    {
+        // Past the cap, connections wait in the backlog of the listener
+        if(sem_wait(&connectionSlots)) continue;
+
+        int fd = accept(listener, NULL, NULL);
+
+        if(fd < 0)
+        {
+            sem_post(&connectionSlots);
+
+            if(errno == EINTR || errno == ECONNABORTED) continue;
+
+            fprintf(stderr, "Could not accept a connection: %s\n", strerror(errno));
+            break;
+        }
+
+        Connection* connection = (Connection*)malloc(sizeof(Connection));
+
+        if(!connection)
+        {
+            close(fd);
+            sem_post(&connectionSlots);
+            continue;
+        }
+
+        connection->fd = fd;
+        connection->cacheDirectory = cacheDirectory;
+
+        // Without a thread, the connection is served right here
+        pthread_t thread;
+        if(pthread_create(&thread, &detached, serveConnection, connection))
+            serveConnection(connection);
+    }
+
+    pthread_attr_destroy(&detached);
+    close(listener);
+
+    // Every slot is given back once the connections being served are done
+    for(int i = 0; i < COMPILE_SERVER_MAX_CONNECTIONS; i++)
+        while(sem_wait(&connectionSlots) && errno == EINTR);
+
+    sem_destroy(&connectionSlots);
+    unlink(socketPath);
+
+    printf("Served %d compilations, %d of them from the cache.\n", servedCount, cachedCount);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#ifndef __COMPILE_SERVER_H__
+#define __COMPILE_SERVER_H__
+
+#include <stddef.h>
+#include "code_generator.h"
+#include "compile_cache.h"
+
+/**
+ * The protocol of the compiler server, over a Unix domain stream socket. A
+ * .. connection carries a single compilation:
+ *  request : "PL0 <kind> <length> <maxCodeLength> <peepholePasses>
+ *             <eliminateDeadCode> <inlineThreshold>\n" on one line, followed
+ *             by the length bytes of the input. kind is a CompileInputKind.
+ *  response: "<compiled|cached|failed> <code|error> <length>\n", followed by
+ *             the length bytes of the output.
+ * The output is exactly what code_generator.out writes to its output file:
+ * .. the PM/0 code, or the lexical or code generator error. A request the
+ * .. server cannot serve is answered as failed, with a message as output.
+ * */
+
+/**
+ * The largest input the server accepts, in bytes.
+ * */
+#define COMPILE_SERVER_MAX_INPUT_LENGTH (1 << 28)
+
+/**
+ * The most connections the server serves at a time. Further ones wait to be
+ * .. accepted until one of them is done.
+ * */
+#define COMPILE_SERVER_MAX_CONNECTIONS 32
+
+/**
+ * The most seconds the server waits on a connection for the next bytes of
+ * .. the request, or for the client to take the response, before dropping it.
+ * */
+#define COMPILE_SERVER_TIMEOUT 10
+
+/**
+ * The outcome of a compilation.
+ * */
+typedef struct {
+    int cached;          // whether the output was read from the cache
+    int isError;         // whether the output is an error message
+    char* output;        // null-terminated, allocated
+    size_t outputLength; // in bytes, without the terminator
+} CompileResult;
+
+/**
+ * Compiles the given input, which is not modified, with the given options.
+ * Returns 0 on success, filling the result, which the caller should delete
+ * .. with deleteCompileResult(). Returns -1 if the space for the output could
+ * .. not be allocated.
+ * */
+int compileInput(const char* input, size_t length, CompileInputKind, CodeGenOptions, CompileResult*);
+
+/**
+ * compileInput(), but the output is read from the cache in the given
+ * .. directory if it holds an entry for the same input and options, and
+ * .. stored in it otherwise.
+ * */
+int compileWithCache(const char* cacheDirectory, const char* input, size_t length, CompileInputKind, CodeGenOptions, CompileResult*);
+
+/**
+ * Sends the given compilation to the server listening on the given socket.
+ * Returns 0 on success, filling the result as compileInput() does. Returns
+ * .. -1 if no server is listening or the server failed, in which case the
+ * .. input can be compiled locally instead.
+ * */
+int requestCompilation(const char* socketPath, const char* input, size_t length, CompileInputKind, CodeGenOptions, CompileResult*);
+
+/**
+ * Listens on the given socket and serves compilations, each on its own
+ * .. thread, through the cache in the given directory, which has to exist.
+ * Runs until SIGINT or SIGTERM, then waits for the connections being served
+ * .. and removes the socket.
+ * Returns 0 after a stop, -1 if the socket could not be set up.
+ * */
+int serveCompilations(const char* socketPath, const char* cacheDirectory);
+
+/**
+ * Makes the necessary deallocations on the CompileResult.
+ * */
+void deleteCompileResult(CompileResult*);
+
+#endif
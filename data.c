@@ -20,6 +20,21 @@ const char* tokenNames[] = {
     [writesym] = "writesym", [readsym] = "readsym", [elsesym] =      "elsesym"
 };
 
+const char* tokens[] = {
+    // Special symbols (+ odd)
+    [plussym]    = "+", [minussym] = "-", [multsym]      = "*", [slashsym]  = "/",
+    [oddsym]     = "odd", [eqsym]  = "=", [neqsym]       = "<>", [lessym]   = "<",
+    [leqsym]     = "<=", [gtrsym]  = ">", [geqsym]       = ">=", [lparentsym] = "(",
+    [rparentsym] = ")", [commasym] = ",", [semicolonsym] = ";", [periodsym] = ".",
+    [becomessym] = ":=",
+
+    // Reserved words
+    [beginsym] = "begin", [endsym]  = "end",  [ifsym]    = "if",    [thensym] = "then",
+    [whilesym] = "while", [dosym]   = "do",   [callsym]  = "call",
+    [constsym] = "const", [varsym]  = "var",  [procsym]  = "procedure",
+    [writesym] = "write", [readsym] = "read", [elsesym]  = "else"
+};
+
 const char* codeGeneratorErrMsg[] =
 {
     [0] = "SUCCESS",
@@ -42,7 +57,8 @@ const char* codeGeneratorErrMsg[] =
     [16] = "Assignment to constant or procedure is not allowed",
     [17] = "Call of a constant or variable is not allowed",
     [18] = "Write of a prodecure is not allowed",
-    [19] = "Read to a constant or prodecure is not allowed"
+    [19] = "Read to a constant or prodecure is not allowed",
+    [20] = "Program exceeds the maximum code length"
 };
 
 const char* nonTerminalNames[] = {
@@ -1,8 +1,14 @@
 #ifndef __DATA_H__
 #define __DATA_H__
 
-#define MAX_CODE_LENGTH 500
+// The VM loads programs of any length, so this only guards against runaway
+// .. code generation
+#define MAX_CODE_LENGTH 1048576
 #define AR_VARIABLE_OFFSET 4
+// The size of the register file of the VM
+#define REGISTER_FILE_REG_COUNT 16
+#define MAX_IDENTIFIER_LENGTH 11
+#define MAX_NUM_DIGIT_LENGTH 5
 
 // Instruction
 typedef struct {
@@ -38,6 +44,11 @@ enum {
     writesym = 31, readsym = 32, elsesym  = 33
 };
 
+// The range of tokens that have a fixed spelling (special symbols, 'odd' and reserved words)
+enum {
+    firstReservedToken = plussym, lastReservedToken = elsesym
+};
+
 // Enumeration for non-terminals
 typedef enum {
     PROGRAM, BLOCK, CONST_DECLARATION, VAR_DECLARATION, PROC_DECLARATION,
@@ -47,6 +58,9 @@ typedef enum {
 // The string representation of each token, if applicable (identsym and numbersym excluded)
 extern const char* tokenNames[];
 
+// The spelling of each token in the source code, if applicable (firstReservedToken..lastReservedToken)
+extern const char* tokens[];
+
 extern const char* codeGeneratorErrMsg[];
 
 extern const char* nonTerminalNames[];
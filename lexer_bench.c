@@ -0,0 +1,173 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "source_code.h"
+#include "lexical_analyzer.h"
+
+/**
+ * Lexer throughput benchmark. Generates a large, lexically valid PL/0 source
+ * .. in memory and measures how fast lexicalAnalyzer() consumes it with each
+ * .. implementation of the scanning kernels (see scanner.h).
+ * */
+
+#define DEFAULT_SOURCE_MB 16
+#define DEFAULT_REPETITIONS 5
+
+/**
+ * The PL/0 snippets repeated to build the benchmark sources. Dense code is
+ * .. dominated by the cost of producing tokens; commented code, with long
+ * .. comments and deep indentation, by the cost of skipping characters.
+ * */
+static const char* denseSnippet =
+    "var counter, accumulator, limit;\n"
+    "begin\n"
+    "    read limit;\n"
+    "    counter := 1;\n"
+    "    accumulator := 0;\n"
+    "    while counter <= limit do\n"
+    "    begin\n"
+    "        accumulator := accumulator + counter;\n"
+    "        counter := counter + 1\n"
+    "    end;\n"
+    "    if odd accumulator then write 12345 else write accumulator\n"
+    "end\n";
+
+static const char* commentedSnippet =
+    "/**\n"
+    " * Computes the sum of the numbers from 1 to limit, then writes it. The\n"
+    " * .. loop below runs limit times, adding the counter to the accumulator\n"
+    " * .. and incrementing the counter at each iteration. If the sum is odd,\n"
+    " * .. a fixed number is written instead of the sum itself, to exercise\n"
+    " * .. both branches of the if statement during testing.\n"
+    " * */\n"
+    "var counter, accumulator, limit;\n"
+    "begin\n"
+    "                                read limit;\n"
+    "                                /* Start counting from one */\n"
+    "                                counter := 1;\n"
+    "                                accumulator := 0;\n"
+    "                                while counter <= limit do\n"
+    "                                begin\n"
+    "                                                                accumulator := accumulator + counter;\n"
+    "                                                                counter := counter + 1\n"
+    "                                end;\n"
+    "                                if odd accumulator then write 12345 else write accumulator\n"
+    "end\n";
+
+/**
+ * Returns the number of seconds elapsed since an arbitrary point.
+ * */
+double getSeconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Lexes the source repetitions times with the kernels selected by the value
+ * .. of PL0_SCANNER. Prints and returns the best throughput in MB/s.
+ * Returns -1 if lexical analysis fails.
+ * */
+double benchmarkScanner(const char* scanner, SourceCode sourceCode, int repetitions)
+{
+    double best = 0;
+    int numberOfTokens = 0;
+    int r;
+
+    setenv("PL0_SCANNER", scanner, 1);
+
+    for(r = 0; r < repetitions; r++)
+    {
+        double start = getSeconds();
+        LexerOut lexerOut = lexicalAnalyzer(sourceCode);
+        double elapsed = getSeconds() - start;
+
+        if(lexerOut.lexerError != NONE)
+        {
+            fprintf(stderr, "Lexer error %d on line %d\n", lexerOut.lexerError, lexerOut.errorLine);
+            deleteLexerOut(&lexerOut);
+            return -1;
+        }
+
+        numberOfTokens = lexerOut.tokenList.numberOfTokens;
+        deleteLexerOut(&lexerOut);
+
+        if(best == 0 || elapsed < best) best = elapsed;
+    }
+
+    printf("  %-8s %8.1f MB/s %10d tokens\n", scanner, sourceCode.length / best / 1e6, numberOfTokens);
+
+    return sourceCode.length / best / 1e6;
+}
+
+/**
+ * Builds a source of about sourceMB megabytes by repeating the snippet, and
+ * .. benchmarks each implementation of the scanning kernels on it.
+ * Returns 0 on success, -1 otherwise.
+ * */
+int benchmarkSource(const char* name, const char* snippet, int sourceMB, int repetitions)
+{
+    size_t snippetLength = strlen(snippet);
+    size_t capacity = (size_t)sourceMB * 1000000;
+    size_t length = 0;
+    SourceCode sourceCode;
+    double scalar, sse2, avx2;
+    char* text;
+
+    if( !(text = malloc(capacity)) )
+    {
+        fprintf(stderr, "Could not allocate %d MB\n", sourceMB);
+        return -1;
+    }
+
+    // The repeated snippets do not form a valid program, which is irrelevant
+    // .. to the lexer.
+    while(length + snippetLength <= capacity)
+    {
+        memcpy(text + length, snippet, snippetLength);
+        length += snippetLength;
+    }
+
+    sourceCode.text = text;
+    sourceCode.length = length;
+    sourceCode.mapping = NULL;
+    sourceCode.mappingLength = 0;
+
+    printf("%s code, %.1f MB, best of %d runs\n", name, length / 1e6, repetitions);
+
+    scalar = benchmarkScanner("scalar", sourceCode, repetitions);
+    sse2 = benchmarkScanner("sse2", sourceCode, repetitions);
+    avx2 = benchmarkScanner("avx2", sourceCode, repetitions);
+
+    free(text);
+
+    if(scalar < 0 || sse2 < 0 || avx2 < 0) return -1;
+
+    printf("  speedup over scalar: sse2 %.2fx, avx2 %.2fx\n", sse2 / scalar, avx2 / scalar);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int sourceMB = argc > 1 ? atoi(argv[1]) : DEFAULT_SOURCE_MB;
+    int repetitions = argc > 2 ? atoi(argv[2]) : DEFAULT_REPETITIONS;
+
+    if(sourceMB <= 0 || repetitions <= 0)
+    {
+        fprintf(stderr, "Usage: ./lexer_bench.out [source_size_in_MB] [repetitions]\n");
+        return -1;
+    }
+
+    if(benchmarkSource("Dense", denseSnippet, sourceMB, repetitions)) return -1;
+
+    if(benchmarkSource("Commented", commentedSnippet, sourceMB, repetitions)) return -1;
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <string.h>
+#include "token.h"
+#include "token_stream.h"
+#include "source_code.h"
+#include "lexical_analyzer.h"
+
+int main(int argc, char **argv)
+{
+    FILE *inp, *outp;
+
+    // Whether the tokens are written as a binary token stream rather than
+    // .. a text table
+    int binaryTokens = 0;
+
+    /**********************************/
+    /* Parse Command Line Arguments */
+    /**********************************/
+    if(argc == 4 && !strcmp(argv[1], "--binary-tokens"))
+    {
+        binaryTokens = 1;
+        argc--;
+        argv++;
+    }
+
+    if(argc != 3)
+    {
+        fprintf(stderr, "Usage: ./lexical_analyzer.out [--binary-tokens] (pl0_code) (lexer_output_file)\n");
+
+        fprintf(stderr, "\n       --binary-tokens: Write the list of tokens as a binary token stream (see token_stream.h) instead of a token table.\n");
+
+        fprintf(stderr, "\n       pl0_code: The path to the file containing the source code written in the programming language PL/0. Use dash ('-') to read from stdin.\n");
+
+        fprintf(stderr, "\n       lexer_output_file: The path to the file to write the lexer output, which could contain either the list of tokens or lexer error message.\n");
+        return -1;
+    }
+
+    // open the input file for reading
+    if( !(inp = (argv[1][0] == '-' && argv[1][1] == '\0') ? stdin : fopen(argv[1], "r")) )
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[1]);
+        return -1;
+    }
+
+    // open the output file for writing
+    if( !(outp = fopen(argv[2], binaryTokens ? "wb" : "w")) )
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[2]);
+
+        // Before terminating, close the input file
+        if(inp != stdin) fclose(inp);
+
+        return -1;
+    }
+
+    /**********************************/
+    /**** Call to lexical analyzer ****/
+    /**********************************/
+    // Read the source code
+    SourceCode sourceCode = readSourceCode(inp);
+
+    // Run lexical analyzer
+    LexerOut lexerOut = lexicalAnalyzer(sourceCode);
+
+    // Print either the tokens or the error
+    if(lexerOut.lexerError == NONE && binaryTokens)
+    {
+        if(writeTokenStream(lexerOut.tokenList, outp))
+            fprintf(stderr, "Could not write the token stream to \"%s\"\n", argv[2]);
+    }
+    else if(lexerOut.lexerError == NONE)
+        printTokenList(lexerOut.tokenList, outp);
+    else
+        printLexErr(lexerOut.lexerError, lexerOut.errorLine, outp);
+
+    // Delete the token list created by lexicalAnalyzer() and the source code
+    deleteLexerOut(&lexerOut);
+    deleteSourceCode(&sourceCode);
+
+    /**********************************/
+    /* Closing input and output files */
+    /**********************************/
+
+    // close the input and the output file stream
+    if(inp && inp != stdin) fclose(inp);
+    if(outp) fclose(outp);
+
+    return 0;
+}
@@ -1,435 +1,434 @@
-#include "lexical_analyzer.h"
-#include "data.h"
-#include "token.h"
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h> // Declares isalpa, isdigit, isalnum
-
-/* ************************************************************************** */
-/* Enumarations, Typename Aliases, Helpers Structs ************************** */
-/* ************************************************************************** */
-
-typedef enum {
-    ALPHA,   // a, b, .. , z, A, B, .. Z
-    DIGIT, // 0, 1, .. , 9
-    SPECIAL, // '>', '=', , .. , ';', ':'
-    INVALID  // Invalid symbol
-} SymbolType;
-
-/**
- * Following struct is recommended to use to keep track of the current state
- * .. of the lexer, and modify the state in other functions by passing pointer
- * .. to the state as argument.
- * */
-typedef struct {
-    int lineNum;         // the line number currently being processed
-    int charInd;         // the index of the character currently being processed
-    char* sourceCode;    // null-terminated source code string
-    LexErr lexerError;   // LexErr to be filled when Lexer faces an error
-    TokenList tokenList; // list of tokens
-} LexerState;
-
-/* ************************************************************************** */
-/* Declarations ************************************************************* */
-/* ************************************************************************** */
-
-/**
- * Initializes the LexerState with the given null-terminated source code string.
- * Sets the other fields of the LexerState to their inital values.
- * Shallow copying is done for the source code field.
- * */
-void initLexerState(LexerState*, char* sourceCode);
-
-/**
- * Returns 1 if the given character is valid.
- * Returns 0 otherwise.
- * */
-int isCharacterValid(char);
-
-/**
- * Returns 1 if the given character is one of the special symbols of PL/0,
- * .. such as '/', '=', ':' or ';'.
- * Returns 0 otherwise.
- * */
-int isSpecialSymbol(char);
-
-/**
- * Returns the symbol type of the given character.
- * */
-SymbolType getSymbolType(char);
-
-/**
- * Checks if the given symbol is one of the reserved token.
- * If yes, returns the numerical value assigned to the corresponding token.
- * If not, returns -1.
- * For example, calling the function with symbol "const" returns 28.
- * */
-int checkReservedTokens(char* symbol);
-
-/**
- * Deterministic-finite-automaton to be entered when an alpha character is seen.
- * Simulating a state machine, consumes the source code and changes the state
- * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
- * .. token list field of the LexerState.
- * If an error is encountered, sets the LexErr field of LexerState, sets the
- * .. line number field and returns.
- * */
-void DFA_Alpha(LexerState*);
-
-/**
- * Deterministic-finite-automaton to be entered when a digit character is seen.
- * Simulating a state machine, consumes the source code and changes the state
- * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
- * .. token list field of the LexerState.
- * If an error is encountered, sets the LexErr field of LexerState, sets the
- * .. line number field and returns.
- * */
-void DFA_Digit(LexerState*);
-
-/**
- * Deterministic-finite-automaton to be entered when a special character is seen.
- * Simulating a state machine, consumes the source code and changes the state
- * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
- * .. token list field of the LexerState.
- * If an error is encountered, sets the LexErr field of LexerState, sets the
- * .. line number field and returns.
- * */
-void DFA_Special(LexerState*);
-
-/* ************************************************************************** */
-/* Definitions ************************************************************** */
-/* ************************************************************************** */
-
-void initLexerState(LexerState* lexerState, char* sourceCode)
-{
-    lexerState->lineNum = 0;
-    lexerState->charInd = 0;
-    lexerState->sourceCode = sourceCode;
-    lexerState->lexerError = NONE;
-
-    initTokenList(&lexerState->tokenList);
-}
-
-int isCharacterValid(char c)
-{
-    return isalnum(c) || isspace(c) || isSpecialSymbol(c);
-}
-
-int isSpecialSymbol(char c)
-{
-    return c == '+' || c == '-' || c == '*' || c == '/' ||
-           c == '(' || c == ')' || c == '=' || c == ',' ||
-           c == '.' || c == '<' || c == '>' || c == ';' ||
-           c == ':';
-}
-
-SymbolType getSymbolType(char c)
-{
-         if(isalpha(c))         return ALPHA;
-    else if(isdigit(c))         return DIGIT;
-    else if(isSpecialSymbol(c)) return SPECIAL;
-    else                        return INVALID;
-}
-
-int checkReservedTokens(char* symbol)
-{
-    for(int i = firstReservedToken; i <= lastReservedToken; i++)
-    {
-        if( !strcmp(symbol, tokens[i]) )
-        {
-            // Symbol is the reserved token at index i.
-            return i;
-        }
-    }
-
-    // Symbol is not found among the reserved tokens
-    return -1;
-}
-
-
-/**
- * Deterministic-finite-automaton to be entered when an alpha character is seen.
- * Simulating a state machine, consumes the source code and changes the state
- * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
- * .. token list field of the LexerState.
- * If an error is encountered, sets the LexErr field of LexerState, sets the
- * .. line number field and returns.
- * */
-void DFA_Alpha(LexerState* lexerState)
-{
-    // There are two possible cases for symbols starting with alpha:
-    // Case.1) A reversed token (a reserved word or 'odd')
-    // Case.2) An ident
-
-    // In both cases, symbol should not exceed 11 characters.
-    // Read 11 or less alpha-numeric characters
-    // If it exceeds 11 alnums, fill LexerState error and return
-    // Otherwise, try to recognize if the symbol is reserved.
-    //   If yes, tokenize by one of the reserved symbols
-    //   If not, tokenize as ident.
-
-    // For adding a token to tokenlist, you could create a token, fill its
-    // .. fields as required and use the following call:
-    // addToken(&lexerState->tokenList, token);
-
-
-    char c = lexerState->sourceCode[lexerState->charInd];
-
-    int curLen = 1;
-	Token *token = (Token*)malloc(sizeof(Token));
-	token->lexeme[0]=c;
-	lexerState->charInd++;
-	while(1){
-		//Find next char
-		char nextChar = lexerState->sourceCode[lexerState->charInd];
-		int symbolType = getSymbolType(nextChar);
-		if(symbolType==ALPHA || symbolType==DIGIT){
-            //Check if length is too long
-			if(curLen==MAX_IDENTIFIER_LENGTH){
-				lexerState->lexerError = NAME_TOO_LONG;
-				return;
-			}
-			lexerState->charInd++;
-			token->lexeme[curLen++]=nextChar;
-		}
-
-		else break;
-	}
-	token->lexeme[curLen]='\0';
-	token->id = checkReservedTokens(token->lexeme);
-
-	if(token->id==-1)token->id=2;
-
-	addToken(&lexerState->tokenList, *token);
-
-    //printf("DFA_Alpha: The character \'%c\' was seen and ignored. Please implement the function.\n", c);
-    // The character was consumed (by ignoring). Advance to the next character.
-    //lexerState->charInd++;
-
-    return;
-}
-
-
-/**
- * Deterministic-finite-automaton to be entered when a digit character is seen.
- * Simulating a state machine, consumes the source code and changes the state
- * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
- * .. token list field of the LexerState.
- * If an error is encountered, sets the LexErr field of LexerState, sets the
- * .. line number field and returns.
- * */
-void DFA_Digit(LexerState* lexerState)
-{
-    // There are three cases for symbols starting with number:
-    // Case.1) It is a well-formed number
-    // Case.2) It is an ill-formed number exceeding 5 digits - Lexer Error!
-    // Case.3) It is an ill-formed variable name starting with digit - Lexer Error!
-
-    // Tokenize as numbersym only if it is case 1. Otherwise, set the required
-    // .. fields of lexerState to corresponding LexErr and return.
-
-    // For adding a token to tokenlist, you could create a token, fill its
-    // .. fields as required and use the following call:
-    // addToken(&lexerState->tokenList, token);
-
-    // Initialize my token.
-    Token *token = (Token*) malloc(sizeof(Token));
-
-    int len = 0;
-
-    while(1) {
-        char curr = lexerState->sourceCode[lexerState->charInd];
-        // Symbol type of curr char
-        int symbolType = getSymbolType(curr);
-        // If symbol is digit, continue
-        if(symbolType == DIGIT) {
-            if(len == MAX_NUM_DIGIT_LENGTH) {
-                lexerState->lexerError = NUM_TOO_LONG;
-                return;
-            } else {
-                lexerState->charInd++;
-                token->lexeme[len++] = curr;
-            }
-        } else if(symbolType == ALPHA) {
-
-            lexerState->lexerError = NONLETTER_VAR_INITIAL;
-            return;
-        } else {
-            break;
-        }
-    }
-    // Include null terminator
-    token->lexeme[len] = '\0';
-    token->id = numbersym;
-
-    addToken(&lexerState->tokenList, *token);
-
-    return;
-}
-
-void DFA_Special(LexerState* lexerState)
-{
-    // There are three cases for symbols starting with special:
-    // Case.1: Beginning of a comment: "/*"
-    // Case.2: Two character special symbol: "<>", "<=", ">=", ":="
-    // Case.3: One character special symbol: "+", "-", "(", etc.
-
-    // For case.1, you are recommended to consume all the characters regarding
-    // .. the comment, and return. This way, lexicalAnalyzer() func can decide
-    // .. what to do with the next character.
-
-    // For case.2 and case.3, you could consume the characters, add the
-    // .. corresponding token to the tokenlist of lexerState, and return.
-
-    // For adding a token to tokenlist, you could create a token, fill its
-    // .. fields as required and use the following call:
-    // addToken(&lexerState->tokenList, token);
-
-    char c = lexerState->sourceCode[lexerState->charInd];
-
-	Token *token = (Token*)malloc(sizeof(Token));
-	token->lexeme[0]=c;
-	lexerState->charInd++;
-	if(c == '/'){
-		char next = lexerState->sourceCode[lexerState->charInd];
-		if(next == '*'){
-			lexerState->charInd++;
-			char prev = '-';
-			while(1){
-				next = lexerState->sourceCode[lexerState->charInd];
-				lexerState->charInd++;
-				if(next=='/' && prev=='*') return;
-				prev = next;
-			}
-		}
-		else{
-			token->lexeme[1]='\0';
-			token->id = checkReservedTokens(token->lexeme);
-			addToken(&lexerState->tokenList,*token);
-			return;
-		}
-	}
-	else{
-		char next = lexerState->sourceCode[lexerState->charInd];
-		token->lexeme[1]='\0';
-		int idLen1 = checkReservedTokens(token->lexeme);
-		int idLen2 = -1;
-		if(next != '\0'){
-			token->lexeme[1]=next;
-			token->lexeme[2]='\0';
-			idLen2 = checkReservedTokens(token->lexeme);
-		}
-		if(idLen2 != -1){
-			lexerState->charInd++;
-			token->id=idLen2;
-			addToken(&lexerState->tokenList,*token);
-			return;
-		}
-		else{
-			token->lexeme[1]='\0';
-			if(idLen1 != -1){
-				token->id=idLen1;
-				addToken(&lexerState->tokenList,*token);
-				return;
-			}
-			else{
-				lexerState->lexerError = INV_SYM;
-				return;
-			}
-		}
-	}
-
-    return;
-}
-
-LexerOut lexicalAnalyzer(char* sourceCode)
-{
-    if(!sourceCode)
-    {
-        fprintf(stderr, "ERROR: Null source code string passed to lexicalAnalyzer()\n");
-
-        LexerOut lexerOut;
-        lexerOut.lexerError = NO_SOURCE_CODE;
-        lexerOut.errorLine = -1;
-
-        return lexerOut;
-    }
-
-    // Create & init lexer state
-    LexerState lexerState;
-    initLexerState(&lexerState, sourceCode);
-
-    // While not end of file, and, there is no lexer error
-    // .. continue lexing
-    while( lexerState.sourceCode[lexerState.charInd] != '\0' &&
-        lexerState.lexerError == NONE )
-    {
-        char currentSymbol = lexerState.sourceCode[lexerState.charInd];
-
-        // Skip spaces or new lines until an effective character is seen
-        while(currentSymbol == ' ' || currentSymbol == '\n' || currentSymbol == '\r')
-        {
-            // Advance line number if required
-            if(currentSymbol == '\n')
-                lexerState.lineNum++;
-
-            // Advance to the following character
-            currentSymbol = lexerState.sourceCode[++lexerState.charInd];
-        }
-
-        // After recognizing spaces or new lines, make sure that the EOF was
-        // .. not reached. If it was, break the loop.
-        if(lexerState.sourceCode[lexerState.charInd] == '\0')
-        {
-            break;
-        }
-
-        // Take action depending on the current symbol's type
-        switch(getSymbolType(currentSymbol))
-        {
-            case ALPHA:
-                DFA_Alpha(&lexerState);
-                break;
-            case DIGIT:
-                DFA_Digit(&lexerState);
-                break;
-            case SPECIAL:
-                DFA_Special(&lexerState);
-                break;
-            case INVALID:
-                lexerState.lexerError = INV_SYM;
-                break;
-        }
-    }
-
-    // Prepare LexerOut to be returned
-    LexerOut lexerOut;
-
-    if(lexerState.lexerError != NONE)
-    {
-        // Set LexErr
-        lexerOut.lexerError = lexerState.lexerError;
-
-        // Set the number of line the error encountered
-        lexerOut.errorLine = lexerState.lineNum;
-
-        lexerOut.tokenList = lexerState.tokenList;
-    }
-    else
-    {
-        // No error!
-        lexerOut.lexerError = NONE;
-        lexerOut.errorLine = -1;
-
-        // Copy the token list
-
-        // The scope of LexerState ends here. The ownership of the tokenlist
-        // .. is being passed to LexerOut. Therefore, neither deletion of the
-        // .. tokenlist nor deep copying of the tokenlist is required.
-        lexerOut.tokenList = lexerState.tokenList;
-    }
-
-    return lexerOut;
-}
+#include "lexical_analyzer.h"
+#include "reserved_tokens.h"
+#include "scanner.h"
+#include "data.h"
+#include "token.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ************************************************************************** */
+/* Enumarations, Typename Aliases, Helpers Structs ************************** */
+/* ************************************************************************** */
+
+/**
+ * The expected number of source code characters per token, which is used to
+ * .. reserve space for the token list up front. Overestimating the number of
+ * .. tokens is cheap since the unused capacity is released before the token
+ * .. list is handed off.
+ * */
+#define SOURCE_CHARS_PER_TOKEN_ESTIMATE 4
+
+typedef enum {
+    ALPHA,   // a, b, .. , z, A, B, .. Z
+    DIGIT, // 0, 1, .. , 9
+    SPECIAL, // '>', '=', , .. , ';', ':'
+    INVALID  // Invalid symbol
+} SymbolType;
+
+/**
+ * Following struct is recommended to use to keep track of the current state
+ * .. of the lexer, and modify the state in other functions by passing pointer
+ * .. to the state as argument.
+ * */
+typedef struct {
+    int lineNum;            // the line number currently being processed
+    size_t charInd;         // the index of the character currently being processed
+    const char* sourceCode; // source code characters, not null-terminated
+    size_t sourceLength;    // number of characters in sourceCode
+    LexErr lexerError;   // LexErr to be filled when Lexer faces an error
+    TokenList tokenList; // list of tokens
+    const ScannerKernels* scanner; // kernels used to consume runs of characters
+} LexerState;
+
+/* ************************************************************************** */
+/* Declarations ************************************************************* */
+/* ************************************************************************** */
+
+/**
+ * Initializes the LexerState with the given source code view.
+ * Sets the other fields of the LexerState to their inital values.
+ * Shallow copying is done for the source code field.
+ * */
+void initLexerState(LexerState*, SourceCode sourceCode);
+
+/**
+ * Returns the character that is offset characters ahead of the one currently
+ * .. being processed. Returns '\0' if the position is past the end of the
+ * .. source code, so the DFAs can look ahead without checking the bounds.
+ * */
+char peekChar(LexerState*, size_t offset);
+
+/**
+ * Returns 1 if the given character is valid.
+ * Returns 0 otherwise.
+ * */
+int isCharacterValid(char);
+
+/**
+ * Returns 1 if the given character is one of the special symbols of PL/0,
+ * .. such as '/', '=', ':' or ';'.
+ * Returns 0 otherwise.
+ * */
+int isSpecialSymbol(char);
+
+/**
+ * Returns the symbol type of the given character.
+ * */
+SymbolType getSymbolType(char);
+
+/**
+ * Deterministic-finite-automaton to be entered when an alpha character is seen.
+ * Simulating a state machine, consumes the source code and changes the state
+ * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
+ * .. token list field of the LexerState.
+ * If an error is encountered, sets the LexErr field of LexerState, sets the
+ * .. line number field and returns.
+ * */
+void DFA_Alpha(LexerState*);
+
+/**
+ * Deterministic-finite-automaton to be entered when a digit character is seen.
+ * Simulating a state machine, consumes the source code and changes the state
+ * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
+ * .. token list field of the LexerState.
+ * If an error is encountered, sets the LexErr field of LexerState, sets the
+ * .. line number field and returns.
+ * */
+void DFA_Digit(LexerState*);
+
+/**
+ * Deterministic-finite-automaton to be entered when a special character is seen.
+ * Simulating a state machine, consumes the source code and changes the state
+ * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
+ * .. token list field of the LexerState.
+ * If an error is encountered, sets the LexErr field of LexerState, sets the
+ * .. line number field and returns.
+ * */
+void DFA_Special(LexerState*);
+
+/* ************************************************************************** */
+/* Definitions ************************************************************** */
+/* ************************************************************************** */
+
+void initLexerState(LexerState* lexerState, SourceCode sourceCode)
+{
+    lexerState->lineNum = 0;
+    lexerState->charInd = 0;
+    lexerState->sourceCode = sourceCode.text;
+    lexerState->sourceLength = sourceCode.length;
+    lexerState->lexerError = NONE;
+    lexerState->scanner = getScannerKernels(SCANNER_AUTO);
+
+    initTokenList(&lexerState->tokenList);
+    reserveTokenList(&lexerState->tokenList, (int)(sourceCode.length / SOURCE_CHARS_PER_TOKEN_ESTIMATE) + 1);
+}
+
+char peekChar(LexerState* lexerState, size_t offset)
+{
+    size_t ind = lexerState->charInd + offset;
+
+    if(ind >= lexerState->sourceLength)
+        return '\0';
+
+    return lexerState->sourceCode[ind];
+}
+
+int isCharacterValid(char c)
+{
+    return charClasses[(unsigned char)c] != 0;
+}
+
+int isSpecialSymbol(char c)
+{
+    return (charClasses[(unsigned char)c] & CHAR_SPECIAL) != 0;
+}
+
+SymbolType getSymbolType(char c)
+{
+    // Indexed by character class
+    static const SymbolType symbolTypes[CHAR_SPACE + 1] = {
+        [0] = INVALID, [CHAR_ALPHA] = ALPHA, [CHAR_DIGIT] = DIGIT,
+        [CHAR_SPECIAL] = SPECIAL, [CHAR_SPACE] = INVALID
+    };
+
+    return symbolTypes[charClasses[(unsigned char)c]];
+}
+
+
+/**
+ * Deterministic-finite-automaton to be entered when an alpha character is seen.
+ * Simulating a state machine, consumes the source code and changes the state
+ * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
+ * .. token list field of the LexerState.
+ * If an error is encountered, sets the LexErr field of LexerState, sets the
+ * .. line number field and returns.
+ * */
+void DFA_Alpha(LexerState* lexerState)
+{
+    // There are two possible cases for symbols starting with alpha:
+    // Case.1) A reversed token (a reserved word or 'odd')
+    // Case.2) An ident
+
+    // In both cases, symbol should not exceed 11 characters.
+    // Read 11 or less alpha-numeric characters
+    // If it exceeds 11 alnums, fill LexerState error and return
+    // Otherwise, try to recognize if the symbol is reserved.
+    //   If yes, tokenize by one of the reserved symbols
+    //   If not, tokenize as ident.
+
+    // For adding a token to tokenlist, you could create a token, fill its
+    // .. fields as required and use the following call:
+    // addToken(&lexerState->tokenList, token);
+
+
+    // The whole alpha-numeric run is the symbol
+    size_t runEnd = lexerState->scanner->skipAlnumRun(lexerState->sourceCode,
+        lexerState->sourceLength, lexerState->charInd + 1);
+    size_t curLen = runEnd - lexerState->charInd;
+
+    //Check if length is too long
+    if(curLen > MAX_IDENTIFIER_LENGTH){
+        lexerState->lexerError = NAME_TOO_LONG;
+        return;
+    }
+
+    // The token is built on the stack and copied into the token list.
+    Token token;
+    memcpy(token.lexeme, lexerState->sourceCode + lexerState->charInd, curLen);
+    token.lexeme[curLen]='\0';
+    token.id = classifyWord(token.lexeme, (int)curLen);
+
+    lexerState->charInd = runEnd;
+
+    addToken(&lexerState->tokenList, token);
+
+    return;
+}
+
+
+/**
+ * Deterministic-finite-automaton to be entered when a digit character is seen.
+ * Simulating a state machine, consumes the source code and changes the state
+ * .. of the lexer (LexerState) as required. Possibly, adds new tokens to the
+ * .. token list field of the LexerState.
+ * If an error is encountered, sets the LexErr field of LexerState, sets the
+ * .. line number field and returns.
+ * */
+void DFA_Digit(LexerState* lexerState)
+{
+    // There are three cases for symbols starting with number:
+    // Case.1) It is a well-formed number
+    // Case.2) It is an ill-formed number exceeding 5 digits - Lexer Error!
+    // Case.3) It is an ill-formed variable name starting with digit - Lexer Error!
+
+    // Tokenize as numbersym only if it is case 1. Otherwise, set the required
+    // .. fields of lexerState to corresponding LexErr and return.
+
+    // For adding a token to tokenlist, you could create a token, fill its
+    // .. fields as required and use the following call:
+    // addToken(&lexerState->tokenList, token);
+
+    // The whole digit run is the number
+    size_t runEnd = lexerState->scanner->skipDigitRun(lexerState->sourceCode,
+        lexerState->sourceLength, lexerState->charInd);
+    size_t len = runEnd - lexerState->charInd;
+
+    if(len > MAX_NUM_DIGIT_LENGTH) {
+        lexerState->lexerError = NUM_TOO_LONG;
+        return;
+    }
+
+    // A letter right after the digits makes it an ill-formed variable name
+    if(getSymbolType(peekChar(lexerState, len)) == ALPHA) {
+        lexerState->lexerError = NONLETTER_VAR_INITIAL;
+        return;
+    }
+
+    // The token is built on the stack and copied into the token list.
+    Token token;
+    memcpy(token.lexeme, lexerState->sourceCode + lexerState->charInd, len);
+    // Include null terminator
+    token.lexeme[len] = '\0';
+    token.id = numbersym;
+
+    lexerState->charInd = runEnd;
+
+    addToken(&lexerState->tokenList, token);
+
+    return;
+}
+
+void DFA_Special(LexerState* lexerState)
+{
+    // There are three cases for symbols starting with special:
+    // Case.1: Beginning of a comment: "/*"
+    // Case.2: Two character special symbol: "<>", "<=", ">=", ":="
+    // Case.3: One character special symbol: "+", "-", "(", etc.
+
+    // For case.1, you are recommended to consume all the characters regarding
+    // .. the comment, and return. This way, lexicalAnalyzer() func can decide
+    // .. what to do with the next character.
+
+    // For case.2 and case.3, you could consume the characters, add the
+    // .. corresponding token to the tokenlist of lexerState, and return.
+
+    // For adding a token to tokenlist, you could create a token, fill its
+    // .. fields as required and use the following call:
+    // addToken(&lexerState->tokenList, token);
+
+    char c = peekChar(lexerState, 0);
+
+	Token token;
+	token.lexeme[0]=c;
+	lexerState->charInd++;
+	if(c == '/'){
+		char next = peekChar(lexerState, 0);
+		if(next == '*'){
+			// Consume up to and including the terminator. If the comment
+			// .. is not terminated, the rest of the source is consumed.
+			lexerState->charInd = lexerState->scanner->skipCommentBody(lexerState->sourceCode,
+				lexerState->sourceLength, lexerState->charInd + 1, &lexerState->lineNum);
+			return;
+		}
+		else{
+			token.lexeme[1]='\0';
+			token.id = slashsym;
+			addToken(&lexerState->tokenList,token);
+			return;
+		}
+	}
+	else{
+		char next = peekChar(lexerState, 0);
+		int idLen2 = classifySpecialSymbolPair(c, next);
+		if(idLen2 != -1){
+			lexerState->charInd++;
+			token.lexeme[1]=next;
+			token.lexeme[2]='\0';
+			token.id=idLen2;
+			addToken(&lexerState->tokenList,token);
+			return;
+		}
+		else{
+			int idLen1 = classifySpecialSymbol(c);
+			token.lexeme[1]='\0';
+			if(idLen1 != -1){
+				token.id=idLen1;
+				addToken(&lexerState->tokenList,token);
+				return;
+			}
+			else{
+				lexerState->lexerError = INV_SYM;
+				return;
+			}
+		}
+	}
+
+    return;
+}
+
+LexerOut lexicalAnalyzer(SourceCode sourceCode)
+{
+    if(!sourceCode.text)
+    {
+        fprintf(stderr, "ERROR: Empty source code passed to lexicalAnalyzer()\n");
+
+        LexerOut lexerOut;
+        initTokenList(&lexerOut.tokenList);
+        lexerOut.lexerError = NO_SOURCE_CODE;
+        lexerOut.errorLine = -1;
+
+        return lexerOut;
+    }
+
+    // Create & init lexer state
+    LexerState lexerState;
+    initLexerState(&lexerState, sourceCode);
+
+    // While not end of file, and, there is no lexer error
+    // .. continue lexing
+    while( lexerState.charInd < lexerState.sourceLength &&
+        lexerState.lexerError == NONE )
+    {
+        // Skip spaces or new lines until an effective character is seen,
+        // .. advancing the line number as required
+        lexerState.charInd = lexerState.scanner->skipWhitespace(lexerState.sourceCode,
+            lexerState.sourceLength, lexerState.charInd, &lexerState.lineNum);
+
+        // After recognizing spaces or new lines, make sure that the EOF was
+        // .. not reached. If it was, break the loop.
+        if(lexerState.charInd >= lexerState.sourceLength)
+        {
+            break;
+        }
+
+        char currentSymbol = peekChar(&lexerState, 0);
+
+        // Take action depending on the current symbol's type
+        switch(getSymbolType(currentSymbol))
+        {
+            case ALPHA:
+                DFA_Alpha(&lexerState);
+                break;
+            case DIGIT:
+                DFA_Digit(&lexerState);
+                break;
+            case SPECIAL:
+                DFA_Special(&lexerState);
+                break;
+            case INVALID:
+                lexerState.lexerError = INV_SYM;
+                break;
+        }
+    }
+
+    // Prepare LexerOut to be returned
+    LexerOut lexerOut;
+
+    // Give back the space reserved for the estimated number of tokens
+    shrinkTokenList(&lexerState.tokenList);
+
+    if(lexerState.lexerError != NONE)
+    {
+        // Set LexErr
+        lexerOut.lexerError = lexerState.lexerError;
+
+        // Set the number of line the error encountered
+        lexerOut.errorLine = lexerState.lineNum;
+
+        lexerOut.tokenList = lexerState.tokenList;
+    }
+    else
+    {
+        // No error!
+        lexerOut.lexerError = NONE;
+        lexerOut.errorLine = -1;
+
+        // Copy the token list
+
+        // The scope of LexerState ends here. The ownership of the tokenlist
+        // .. is being passed to LexerOut. Therefore, neither deletion of the
+        // .. tokenlist nor deep copying of the tokenlist is required.
+        lexerOut.tokenList = lexerState.tokenList;
+    }
+
+    return lexerOut;
+}
+
+const char* lexerErrMsg[] =
+{
+    [NONE] = "SUCCESS",
+    [NONLETTER_VAR_INITIAL] = "Variable does not start with letter",
+    [NAME_TOO_LONG] = "Name too long",
+    [NUM_TOO_LONG] = "Number too long",
+    [INV_SYM] = "Invalid symbol",
+    [NO_SOURCE_CODE] = "No source code"
+};
+
+void printLexErr(LexErr lexerError, int errorLine, FILE* fp)
+{
+    if(!fp || lexerError == NONE) return;
+
+    fprintf(fp, "LEXICAL ERROR[%d] (line %d): %s.\n", lexerError, errorLine, lexerErrMsg[lexerError]);
+}
@@ -2,6 +2,7 @@
 #define __LEXICAL_ANALYZER_H__
 
 #include "token.h"
+#include "source_code.h"
 #include <stdio.h>
 
 /**
@@ -58,6 +59,17 @@ void deleteLexerOut(LexerOut*);
  * If the analysis is NOT successful, i.e. errors are found in the given source
  * .. code, returns a LexerOut with lexerError and errorLine fields properly set.
  * */
-LexerOut lexicalAnalyzer(char* sourceCode);
+LexerOut lexicalAnalyzer(SourceCode sourceCode);
+
+/**
+ * The string representation of each lexer error.
+ * */
+extern const char* lexerErrMsg[];
+
+/**
+ * Given the lexer error and the line it was encountered, prints error message
+ * on file by applying required formatting.
+ * */
+void printLexErr(LexErr lexerError, int errorLine, FILE* fp);
 
 #endif
\ No newline at end of file
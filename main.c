@@ -1,17 +1,95 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "token.h"
+#include "token_stream.h"
+#include "source_code.h"
 #include "code_generator.h"
+#include "code_object.h"
+#include "compile_server.h"
+#include "peephole.h"
 
 int main(int argc, char **argv)
 {
     FILE *inp, *outp;
 
+    // Whether the lexer out is a binary token stream rather than a text table
+    int binaryTokens = 0;
+
+    // Whether the code is written as a binary PM/0 object rather than text
+    int binaryCode = 0;
+
+    // The socket of the compiler server to compile through, NULL if none
+    const char* serverSocket = NULL;
+
+    CodeGenOptions options = getDefaultCodeGenOptions();
+
     /**********************************/
     /* Parse Command Line Arguments */
     /**********************************/
+    // Options come before the file paths
+    while(argc > 3)
+    {
+        if(!strcmp(argv[1], "--binary-tokens"))
+        {
+            binaryTokens = 1;
+        }
+        else if(!strcmp(argv[1], "--binary-code"))
+        {
+            binaryCode = 1;
+        }
+        else if(!strcmp(argv[1], "--no-peephole"))
+        {
+            options.peepholePasses = PEEPHOLE_NONE;
+        }
+        else if(!strcmp(argv[1], "--no-dead-code-elimination"))
+        {
+            options.eliminateDeadCode = 0;
+        }
+        else if(!strcmp(argv[1], "--inline-threshold") && argc > 4 && atoi(argv[2]) >= 0)
+        {
+            options.inlineThreshold = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--server") && argc > 4)
+        {
+            serverSocket = argv[2];
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--max-code-length") && argc > 4 && atoi(argv[2]) > 0)
+        {
+            options.maxCodeLength = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else
+        {
+            break;
+        }
+
+        argc--;
+        argv++;
+    }
+
     if(argc != 3)
     {
-        fprintf(stderr, "Usage: ./code_generator.out (pl0_lexer_out) (cg_output_file)\n");
+        fprintf(stderr, "Usage: ./code_generator.out [--binary-tokens] [--binary-code] [--max-code-length n] [--no-peephole] [--no-dead-code-elimination] [--inline-threshold n] [--server socket_path] (pl0_lexer_out) (cg_output_file)\n");
+
+        fprintf(stderr, "\n       --binary-tokens: The lexer out is a binary token stream (see token_stream.h) instead of a token table.\n");
+
+        fprintf(stderr, "\n       --binary-code: Write the code as a binary PM/0 object (see code_object.h), which vm.out loads without parsing, instead of \"op r l m\" lines. Errors are still written as text. Compiles locally even with --server.\n");
+
+        fprintf(stderr, "\n       --max-code-length: The maximum number of instructions of the generated code. Defaults to %d.\n", options.maxCodeLength);
+
+        fprintf(stderr, "\n       --no-peephole: Print the generated code as emitted, without running the peephole optimizer on it.\n");
+
+        fprintf(stderr, "\n       --no-dead-code-elimination: Generate code for every procedure and branch, whether or not it can be reached.\n");
+
+        fprintf(stderr, "\n       --inline-threshold: The size, in syntax tree nodes, of the largest procedure to compile inline at its calls. 0 disables inlining. Defaults to %d.\n", options.inlineThreshold);
+
+        fprintf(stderr, "\n       --server: Compile through the pl0_server listening on the given socket, which answers unchanged inputs from its cache. Compiles locally if the server cannot be reached.\n");
 
         fprintf(stderr, "\n       pl0_lexer_out: The path to the file containing the lexer out for the programming language PL/0.\n");
 
@@ -20,14 +98,14 @@ int main(int argc, char **argv)
     }
 
     // open the input file for reading
-    if( !(inp = fopen(argv[1], "r")) )
+    if( !(inp = fopen(argv[1], binaryTokens ? "rb" : "r")) )
     {
         fprintf(stderr, "Could not open \"%s\"\n", argv[1]);
         return -1;
     }
 
     // open the output file for writing
-    if( !(outp = fopen(argv[2], "w")) )
+    if( !(outp = fopen(argv[2], binaryCode ? "wb" : "w")) )
     {
         fprintf(stderr, "Could not open \"%s\"\n", argv[2]);
 
@@ -37,14 +115,62 @@ int main(int argc, char **argv)
         return -1;
     }              
 
+    /**********************************/
+    /**** Call to compiler server  ****/
+    /**********************************/
+    // The server only sends text code back
+    if(serverSocket && !binaryCode)
+    {
+        SourceCode input = readSourceCode(inp);
+        CompileResult result;
+
+        int served = !requestCompilation(serverSocket, input.text, input.length,
+            binaryTokens ? COMPILE_INPUT_BINARY_TOKENS : COMPILE_INPUT_TOKENS, options, &result);
+
+        deleteSourceCode(&input);
+
+        if(served)
+        {
+            fwrite(result.output, 1, result.outputLength, outp);
+            deleteCompileResult(&result);
+
+            fclose(inp);
+            fclose(outp);
+
+            return 0;
+        }
+
+        // Compile locally instead, from the start of the input
+        rewind(inp);
+    }
+
     /**********************************/
     /**** Call to code generator   ****/
     /**********************************/
     // Read the token list
-    TokenList tokenList = readTokenList(inp);
+    TokenList tokenList = binaryTokens ? readTokenStream(inp) : readTokenList(inp);
     
     // Run code generator
-    int err = codeGenerator(tokenList, outp);
+    int err;
+
+    if(binaryCode)
+    {
+        CodeBuffer code;
+
+        err = compileTokenList(tokenList, options, &code);
+
+        if(!err)
+        {
+            if(writeCodeObject(&code, outp))
+                fprintf(stderr, "Could not write the code to \"%s\"\n", argv[2]);
+
+            deleteCodeBuffer(&code);
+        }
+    }
+    else
+    {
+        err = codeGenerator(tokenList, outp, options);
+    }
 
     // Print error - if there exists any
     if(err) printCGErr(err, outp);
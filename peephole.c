@@ -0,0 +1,209 @@
+#include "peephole.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Returns whether the M field of the given instruction is a code address.
+ * */
+static int isJump(const Instruction* ins)
+{
+    return ins->op == JMP || ins->op == JPC || ins->op == CAL;
+}
+
+/**
+ * Returns whether execution never continues to the instruction following
+ * .. the given one.
+ * */
+static int endsFlow(const Instruction* ins)
+{
+    return ins->op == JMP || ins->op == RTN || ins->op == SIO_HALT;
+}
+
+/**
+ * Sets isTarget[i] for every instruction i some jump or call refers to.
+ * */
+static void markTargets(const CodeBuffer* code, char* isTarget)
+{
+    memset(isTarget, 0, (size_t)code->numberOfInstructions + 1);
+
+    for(int i = 0; i < code->numberOfInstructions; i++)
+    {
+        const Instruction* ins = &code->instructions[i];
+
+        if(isJump(ins) && ins->m >= 0 && ins->m <= code->numberOfInstructions)
+            isTarget[ins->m] = 1;
+    }
+}
+
+/**
+ * Retargets jumps to a JMP to the end of the chain of JMPs, and replaces a
+ * .. JMP to a RTN or SIO_HALT with a copy of it. Returns the number of
+ * .. instructions changed.
+ * */
+static int threadJumps(CodeBuffer* code)
+{
+    int changes = 0;
+    int n = code->numberOfInstructions;
+
+    for(int i = 0; i < n; i++)
+    {
+        Instruction* ins = &code->instructions[i];
+
+        if(ins->op != JMP && ins->op != JPC)
+            continue;
+
+        // A chain longer than n steps is a loop of JMPs, which is left alone
+        int target = ins->m, steps = 0;
+        while(steps <= n && target >= 0 && target < n && code->instructions[target].op == JMP)
+        {
+            target = code->instructions[target].m;
+            steps++;
+        }
+
+        if(steps > n)
+            continue;
+
+        if(target != ins->m)
+        {
+            ins->m = target;
+            changes++;
+        }
+
+        if(ins->op == JMP && target >= 0 && target < n &&
+           (code->instructions[target].op == RTN || code->instructions[target].op == SIO_HALT))
+        {
+            *ins = code->instructions[target];
+            changes++;
+        }
+    }
+
+    return changes;
+}
+
+/**
+ * Marks the jumps to the next instruction as removed. Returns the number of
+ * .. instructions marked.
+ * */
+static int removeDeadJumps(CodeBuffer* code, char* removed)
+{
+    int changes = 0;
+
+    for(int i = 0; i < code->numberOfInstructions; i++)
+    {
+        const Instruction* ins = &code->instructions[i];
+
+        if((ins->op == JMP || ins->op == JPC) && ins->m == i + 1)
+        {
+            removed[i] = 1;
+            changes++;
+        }
+    }
+
+    return changes;
+}
+
+/**
+ * Marks the LODs right after a STO of the same register to the same address
+ * .. as removed, unless they are jumped to: the register already holds the
+ * .. value. Returns the number of instructions marked.
+ * */
+static int removeRedundantLoads(CodeBuffer* code, const char* isTarget, char* removed)
+{
+    int changes = 0;
+
+    for(int i = 1; i < code->numberOfInstructions; i++)
+    {
+        const Instruction* sto = &code->instructions[i - 1];
+        const Instruction* lod = &code->instructions[i];
+
+        if(lod->op == LOD && sto->op == STO && !isTarget[i] && !removed[i - 1] &&
+           lod->r == sto->r && lod->l == sto->l && lod->m == sto->m)
+        {
+            removed[i] = 1;
+            changes++;
+        }
+    }
+
+    return changes;
+}
+
+/**
+ * Marks the instructions following a JMP, RTN or SIO_HALT as removed, up to
+ * .. the next one that is jumped to. Returns the number of instructions
+ * .. marked.
+ * */
+static int removeUnreachableCode(CodeBuffer* code, const char* isTarget, char* removed)
+{
+    int changes = 0;
+
+    for(int i = 0; i < code->numberOfInstructions; i++)
+    {
+        if(removed[i] || !endsFlow(&code->instructions[i]))
+            continue;
+
+        while(i + 1 < code->numberOfInstructions && !isTarget[i + 1])
+        {
+            i++;
+            if(!removed[i])
+            {
+                removed[i] = 1;
+                changes++;
+            }
+        }
+    }
+
+    return changes;
+}
+
+int optimizeCode(CodeBuffer* code, int passes)
+{
+    if(!code || passes == PEEPHOLE_NONE || code->numberOfInstructions == 0)
+        return 0;
+
+    int initialLength = code->numberOfInstructions;
+    size_t size = (size_t)initialLength + 1;
+
+    char* isTarget = (char*)malloc(size);
+    char* removed = (char*)malloc(size);
+
+    if(!isTarget || !removed)
+    {
+        free(isTarget);
+        free(removed);
+        return -1;
+    }
+
+    // Every round either changes some instructions or removes some, and
+    // .. threading only shortens chains, so the loop terminates
+    int changes;
+    do
+    {
+        changes = 0;
+
+        if(passes & PEEPHOLE_JUMP_THREADING)
+            changes += threadJumps(code);
+
+        markTargets(code, isTarget);
+        memset(removed, 0, size);
+
+        int removals = 0;
+
+        if(passes & PEEPHOLE_DEAD_JUMPS)
+            removals += removeDeadJumps(code, removed);
+        if(passes & PEEPHOLE_REDUNDANT_LOADS)
+            removals += removeRedundantLoads(code, isTarget, removed);
+        if(passes & PEEPHOLE_UNREACHABLE_CODE)
+            removals += removeUnreachableCode(code, isTarget, removed);
+
+        if(removals && removeInstructions(code, removed) < 0)
+            break;
+
+        changes += removals;
+    }
+    while(changes);
+
+    free(isTarget);
+    free(removed);
+
+    return initialLength - code->numberOfInstructions;
+}
@@ -0,0 +1,37 @@
+#ifndef __PEEPHOLE_H__
+#define __PEEPHOLE_H__
+
+#include "code_buffer.h"
+
+/**
+ * The passes of the peephole optimizer, to be combined as a bit mask.
+ * PEEPHOLE_JUMP_THREADING   : A jump to a JMP jumps to its target instead. A
+ *                             JMP to a RTN or SIO_HALT is replaced by it.
+ * PEEPHOLE_DEAD_JUMPS       : Jumps to the next instruction are removed.
+ * PEEPHOLE_REDUNDANT_LOADS  : A LOD right after a STO of the same register to
+ *                             the same address is removed.
+ * PEEPHOLE_UNREACHABLE_CODE : The instructions following a JMP, RTN or
+ *                             SIO_HALT are removed up to the next one that
+ *                             is jumped to.
+ * */
+enum {
+    PEEPHOLE_JUMP_THREADING   = 1 << 0,
+    PEEPHOLE_DEAD_JUMPS       = 1 << 1,
+    PEEPHOLE_REDUNDANT_LOADS  = 1 << 2,
+    PEEPHOLE_UNREACHABLE_CODE = 1 << 3,
+
+    PEEPHOLE_NONE = 0,
+    PEEPHOLE_ALL  = (1 << 4) - 1
+};
+
+/**
+ * Runs the given peephole passes on the code of the given CodeBuffer until
+ * .. none of them changes the code any more. Removed instructions are
+ * .. dropped from the buffer, and the targets of JMP, JPC and CAL are
+ * .. relocated accordingly.
+ * Returns the number of instructions removed, -1 if the temporary space
+ * .. could not be allocated, in which case the code is left untouched.
+ * */
+int optimizeCode(CodeBuffer*, int passes);
+
+#endif
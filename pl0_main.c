@@ -0,0 +1,311 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "token.h"
+#include "source_code.h"
+#include "lexical_analyzer.h"
+#include "code_generator.h"
+#include "compile_server.h"
+#include "peephole.h"
+#include "vm/vm.h"
+
+/**
+ * Opens the file at the given path, or returns the given standard stream if
+ * .. the path is a dash ('-').
+ * */
+static FILE* openStream(const char* path, const char* mode, FILE* standardStream)
+{
+    if(path[0] == '-' && path[1] == '\0') return standardStream;
+
+    return fopen(path, mode);
+}
+
+/**
+ * Closes the given stream unless it is a standard stream or NULL.
+ * */
+static void closeStream(FILE* fp)
+{
+    if(fp && fp != stdin && fp != stdout && fp != stderr) fclose(fp);
+}
+
+/**
+ * Writes the token table, as lexical_analyzer.out does, to the file at the
+ * .. given path. Returns 0 on success, -1 if the file could not be opened.
+ * */
+static int dumpTokenList(TokenList tokenList, const char* path)
+{
+    FILE* fp = openStream(path, "w", stdout);
+
+    if(!fp)
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", path);
+        return -1;
+    }
+
+    printTokenList(tokenList, fp);
+    closeStream(fp);
+
+    return 0;
+}
+
+/**
+ * Writes the code, as code_generator.out does, to the file at the given
+ * .. path. Returns 0 on success, -1 if the file could not be opened.
+ * */
+static int dumpCode(const CodeBuffer* code, const char* path)
+{
+    FILE* fp = openStream(path, "w", stdout);
+
+    if(!fp)
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", path);
+        return -1;
+    }
+
+    printCodeBuffer(code, fp);
+    closeStream(fp);
+
+    return 0;
+}
+
+/**
+ * Runs the code the compiler server sent back, after writing it to the file
+ * .. at codePath if it is given, or writes the error it sent back to stderr.
+ * Returns the result of runProgram(), -1 if the code could not be run.
+ * */
+static int runServedCode(const CompileResult* served, const char* codePath, FILE* traceOutp, FILE* vm_inp, FILE* vm_outp, VMOptions vmOptions)
+{
+    if(served->isError)
+    {
+        fwrite(served->output, 1, served->outputLength, stderr);
+        return -1;
+    }
+
+    if(codePath)
+    {
+        FILE* fp = openStream(codePath, "w", stdout);
+
+        if(!fp)
+        {
+            fprintf(stderr, "Could not open \"%s\"\n", codePath);
+            return -1;
+        }
+
+        fwrite(served->output, 1, served->outputLength, fp);
+        closeStream(fp);
+    }
+
+    // The code is loaded from the text just as vm.out loads it
+    FILE* codeStream = served->outputLength ? fmemopen(served->output, served->outputLength, "r") : NULL;
+    int numOfIns = 0;
+    Instruction* instructions = codeStream ? readInstructions(codeStream, &numOfIns) : NULL;
+
+    if(codeStream) fclose(codeStream);
+
+    if(!instructions)
+    {
+        fprintf(stderr, "Could not load the code sent by the server.\n");
+        return -1;
+    }
+
+    int result = runProgram(instructions, numOfIns, traceOutp, vm_inp, vm_outp, vmOptions);
+    free(instructions);
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *inp = NULL, *traceOutp = NULL, *vm_inp = stdin, *vm_outp = stdout;
+
+    // The socket of the compiler server to compile through, NULL if none
+    const char* serverSocket = NULL;
+
+    // The paths the intermediates are written to, NULL if not requested
+    const char* tokensPath = NULL;
+    const char* codePath = NULL;
+    const char* tracePath = NULL;
+
+    CodeGenOptions cgOptions = getDefaultCodeGenOptions();
+
+    VMOptions vmOptions = getDefaultVMOptions();
+    vmOptions.trace = VM_TRACE_OFF;
+
+    // 0 on success, -1 if any stage failed
+    int result = -1;
+
+    /**********************************/
+    /* Parse Command Line Arguments */
+    /**********************************/
+    // Options come before the file paths
+    while(argc > 1 && !strncmp(argv[1], "--", 2))
+    {
+        if(!strcmp(argv[1], "--dump-tokens") && argc > 2)
+        {
+            tokensPath = argv[2];
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--dump-code") && argc > 2)
+        {
+            codePath = argv[2];
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--trace") && argc > 2)
+        {
+            tracePath = argv[2];
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--no-fusion"))
+        {
+            vmOptions.fuseInstructions = 0;
+        }
+        else if(!strcmp(argv[1], "--server") && argc > 2)
+        {
+            serverSocket = argv[2];
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--no-peephole"))
+        {
+            cgOptions.peepholePasses = PEEPHOLE_NONE;
+        }
+        else if(!strcmp(argv[1], "--no-dead-code-elimination"))
+        {
+            cgOptions.eliminateDeadCode = 0;
+        }
+        else if(!strcmp(argv[1], "--inline-threshold") && argc > 2 && atoi(argv[2]) >= 0)
+        {
+            cgOptions.inlineThreshold = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--max-code-length") && argc > 2 && atoi(argv[2]) > 0)
+        {
+            cgOptions.maxCodeLength = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else
+        {
+            break;
+        }
+
+        argc--;
+        argv++;
+    }
+
+    if(argc < 2 || argc > 4 || !strncmp(argv[1], "--", 2))
+    {
+        fprintf(stderr, "Usage: ./pl0 [--dump-tokens file] [--dump-code file] [--trace file] [--no-fusion] [--max-code-length n] [--no-peephole] [--no-dead-code-elimination] [--inline-threshold n] [--server socket_path] (pl0_code) [vm_inp_file=stdin] [vm_outp_file=stdout]\n");
+
+        fprintf(stderr, "\n       Compiles and runs a PL/0 program in a single process: the tokens and the code are passed between the stages in memory.\n");
+
+        fprintf(stderr, "\n       --dump-tokens: Also write the list of tokens as a token table to the given file.\n");
+
+        fprintf(stderr, "\n       --dump-code: Also write the generated PM/0 code to the given file, in the format vm.out loads.\n");
+
+        fprintf(stderr, "\n       --trace: Write the code memory and the execution history of the virtual machine to the given file. The program runs without a trace by default.\n");
+
+        fprintf(stderr, "\n       --no-fusion: Without --trace, execute common instruction sequences one instruction at a time instead of as superinstructions.\n");
+
+        fprintf(stderr, "\n       --max-code-length, --no-peephole, --no-dead-code-elimination, --inline-threshold: The code generator options, as for code_generator.out.\n");
+
+        fprintf(stderr, "\n       --server: Compile through the pl0_server listening on the given socket, which answers unchanged programs from its cache. Compiles locally if the server cannot be reached, or with --dump-tokens.\n");
+
+        fprintf(stderr, "\n       pl0_code: The path to the file containing the source code written in the programming language PL/0. Use dash ('-') to read from stdin.\n");
+
+        fprintf(stderr, "\n       vm_inp_file: The path to the file that is attached as the input stream to the virtual machine. Use dash ('-') to assign to stdin.\n");
+
+        fprintf(stderr, "\n       vm_outp_file: The path to the file that is attached as the output stream to the virtual machine. Use dash ('-') to assign to stdout.\n");
+
+        fprintf(stderr, "\n       Lexical and code generator errors are written to stderr, and the exit status is nonzero if compilation fails or the program faults.\n");
+        return -1;
+    }
+
+    // open the files; a missing vm_inp_file or vm_outp_file means stdin or stdout
+    if( !(inp = openStream(argv[1], "r", stdin)) )
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[1]);
+        goto cleanup;
+    }
+
+    if( argc > 2 && !(vm_inp = openStream(argv[2], "r", stdin)) )
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[2]);
+        goto cleanup;
+    }
+
+    if( argc > 3 && !(vm_outp = openStream(argv[3], "w", stdout)) )
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", argv[3]);
+        goto cleanup;
+    }
+
+    if( tracePath && !(traceOutp = openStream(tracePath, "w", stdout)) )
+    {
+        fprintf(stderr, "Could not open \"%s\"\n", tracePath);
+        goto cleanup;
+    }
+
+    if(traceOutp) vmOptions.trace = VM_TRACE_FULL;
+
+    /**********************************/
+    /** Lexer, code generator and VM **/
+    /**********************************/
+    SourceCode sourceCode = readSourceCode(inp);
+    CompileResult served;
+
+    // The server does not send the tokens back, so dumping them needs a
+    // .. local compilation
+    if(serverSocket && !tokensPath &&
+       !requestCompilation(serverSocket, sourceCode.text, sourceCode.length, COMPILE_INPUT_SOURCE, cgOptions, &served))
+    {
+        result = runServedCode(&served, codePath, traceOutp, vm_inp, vm_outp, vmOptions);
+        deleteCompileResult(&served);
+    }
+    else
+    {
+        LexerOut lexerOut = lexicalAnalyzer(sourceCode);
+
+        if(lexerOut.lexerError != NONE)
+        {
+            printLexErr(lexerOut.lexerError, lexerOut.errorLine, stderr);
+        }
+        else if(!tokensPath || !dumpTokenList(lexerOut.tokenList, tokensPath))
+        {
+            CodeBuffer code;
+            int err = compileTokenList(lexerOut.tokenList, cgOptions, &code);
+
+            if(err)
+            {
+                printCGErr(err, stderr);
+            }
+            else
+            {
+                if(!codePath || !dumpCode(&code, codePath))
+                    result = runProgram(code.instructions, code.numberOfInstructions, traceOutp, vm_inp, vm_outp, vmOptions);
+
+                deleteCodeBuffer(&code);
+            }
+        }
+
+        deleteLexerOut(&lexerOut);
+    }
+
+    deleteSourceCode(&sourceCode);
+
+cleanup:
+    /**********************************/
+    /*********** Closing files ********/
+    /**********************************/
+    closeStream(inp);
+    closeStream(vm_inp);
+    closeStream(vm_outp);
+    closeStream(traceOutp);
+
+    return result;
+}
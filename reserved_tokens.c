@@ -0,0 +1,105 @@
+#include "reserved_tokens.h"
+#include "data.h"
+#include <string.h>
+
+/**
+ * Token ids of the one character special symbols, indexed by the character.
+ * 0 means that the character is not a special symbol on its own.
+ * */
+static const unsigned char specialSymbolTokens[256] = {
+    ['+'] = plussym,   ['-'] = minussym,     ['*'] = multsym,  ['/'] = slashsym,
+    ['('] = lparentsym, [')'] = rparentsym,  ['='] = eqsym,    [','] = commasym,
+    ['.'] = periodsym, ['<'] = lessym,       ['>'] = gtrsym,   [';'] = semicolonsym
+};
+
+/**
+ * The row of specialSymbolPairTokens to be used for the first character of a
+ * .. two character special symbol. Row 0 is all zeros, so characters that
+ * .. cannot start a two character special symbol need no special handling.
+ * */
+static const unsigned char specialSymbolPairRows[256] = {
+    ['<'] = 1, ['>'] = 2, [':'] = 3
+};
+
+/**
+ * Token ids of the two character special symbols, indexed by the row of the
+ * .. first character and the second character. 0 means no such symbol.
+ * */
+static const unsigned char specialSymbolPairTokens[4][256] = {
+    [1] = { ['>'] = neqsym, ['='] = leqsym },
+    [2] = { ['='] = geqsym },
+    [3] = { ['='] = becomessym }
+};
+
+int classifyWord(const char* word, int length)
+{
+    // The only candidate reserved word with the same length and leading
+    // .. characters. The candidate is verified against its spelling below.
+    int candidate;
+
+    switch(length)
+    {
+        case 2:
+            switch(word[0])
+            {
+                case 'i': candidate = ifsym; break;
+                case 'd': candidate = dosym; break;
+                default : return identsym;
+            }
+            break;
+
+        case 3:
+            switch(word[0])
+            {
+                case 'e': candidate = endsym; break;
+                case 'v': candidate = varsym; break;
+                case 'o': candidate = oddsym; break;
+                default : return identsym;
+            }
+            break;
+
+        case 4:
+            switch(word[0])
+            {
+                case 't': candidate = thensym; break;
+                case 'c': candidate = callsym; break;
+                case 'r': candidate = readsym; break;
+                case 'e': candidate = elsesym; break;
+                default : return identsym;
+            }
+            break;
+
+        case 5:
+            switch(word[0])
+            {
+                case 'b': candidate = beginsym; break;
+                case 'c': candidate = constsym; break;
+                case 'w': candidate = word[1] == 'h' ? whilesym : writesym; break;
+                default : return identsym;
+            }
+            break;
+
+        case 9:
+            candidate = procsym;
+            break;
+
+        default:
+            return identsym;
+    }
+
+    return memcmp(word, tokens[candidate], length) ? identsym : candidate;
+}
+
+int classifySpecialSymbol(char c)
+{
+    int id = specialSymbolTokens[(unsigned char)c];
+
+    return id ? id : -1;
+}
+
+int classifySpecialSymbolPair(char first, char second)
+{
+    int id = specialSymbolPairTokens[specialSymbolPairRows[(unsigned char)first]][(unsigned char)second];
+
+    return id ? id : -1;
+}
@@ -0,0 +1,31 @@
+#ifndef __RESERVED_TOKENS_H__
+#define __RESERVED_TOKENS_H__
+
+/**
+ * Classifiers for the tokens that have a fixed spelling: reserved words,
+ * .. 'odd' and special symbols. All of them run in constant time; none of
+ * .. them scans the list of reserved tokens.
+ * */
+
+/**
+ * Returns the token id of the given word if it is a reserved word or 'odd'.
+ * Otherwise, returns identsym.
+ * The word does not need to be null-terminated; length is the number of
+ * .. characters in the word.
+ * For example, classifyWord("const", 5) returns constsym.
+ * */
+int classifyWord(const char* word, int length);
+
+/**
+ * Returns the token id of the one character special symbol c, such as
+ * .. plussym for '+'. Returns -1 if c is not a special symbol on its own.
+ * */
+int classifySpecialSymbol(char c);
+
+/**
+ * Returns the token id of the two character special symbol formed by first
+ * .. and second, i.e. one of "<>", "<=", ">=", ":=". Returns -1 otherwise.
+ * */
+int classifySpecialSymbolPair(char first, char second);
+
+#endif
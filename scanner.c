@@ -0,0 +1,390 @@
+#include "scanner.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCANNER_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define SCANNER_HAS_X86_SIMD 0
+#endif
+
+const unsigned char charClasses[256] = {
+    ['a'] = CHAR_ALPHA, ['b'] = CHAR_ALPHA, ['c'] = CHAR_ALPHA, ['d'] = CHAR_ALPHA,
+    ['e'] = CHAR_ALPHA, ['f'] = CHAR_ALPHA, ['g'] = CHAR_ALPHA, ['h'] = CHAR_ALPHA,
+    ['i'] = CHAR_ALPHA, ['j'] = CHAR_ALPHA, ['k'] = CHAR_ALPHA, ['l'] = CHAR_ALPHA,
+    ['m'] = CHAR_ALPHA, ['n'] = CHAR_ALPHA, ['o'] = CHAR_ALPHA, ['p'] = CHAR_ALPHA,
+    ['q'] = CHAR_ALPHA, ['r'] = CHAR_ALPHA, ['s'] = CHAR_ALPHA, ['t'] = CHAR_ALPHA,
+    ['u'] = CHAR_ALPHA, ['v'] = CHAR_ALPHA, ['w'] = CHAR_ALPHA, ['x'] = CHAR_ALPHA,
+    ['y'] = CHAR_ALPHA, ['z'] = CHAR_ALPHA,
+
+    ['A'] = CHAR_ALPHA, ['B'] = CHAR_ALPHA, ['C'] = CHAR_ALPHA, ['D'] = CHAR_ALPHA,
+    ['E'] = CHAR_ALPHA, ['F'] = CHAR_ALPHA, ['G'] = CHAR_ALPHA, ['H'] = CHAR_ALPHA,
+    ['I'] = CHAR_ALPHA, ['J'] = CHAR_ALPHA, ['K'] = CHAR_ALPHA, ['L'] = CHAR_ALPHA,
+    ['M'] = CHAR_ALPHA, ['N'] = CHAR_ALPHA, ['O'] = CHAR_ALPHA, ['P'] = CHAR_ALPHA,
+    ['Q'] = CHAR_ALPHA, ['R'] = CHAR_ALPHA, ['S'] = CHAR_ALPHA, ['T'] = CHAR_ALPHA,
+    ['U'] = CHAR_ALPHA, ['V'] = CHAR_ALPHA, ['W'] = CHAR_ALPHA, ['X'] = CHAR_ALPHA,
+    ['Y'] = CHAR_ALPHA, ['Z'] = CHAR_ALPHA,
+
+    ['0'] = CHAR_DIGIT, ['1'] = CHAR_DIGIT, ['2'] = CHAR_DIGIT, ['3'] = CHAR_DIGIT,
+    ['4'] = CHAR_DIGIT, ['5'] = CHAR_DIGIT, ['6'] = CHAR_DIGIT, ['7'] = CHAR_DIGIT,
+    ['8'] = CHAR_DIGIT, ['9'] = CHAR_DIGIT,
+
+    ['+'] = CHAR_SPECIAL, ['-'] = CHAR_SPECIAL, ['*'] = CHAR_SPECIAL, ['/'] = CHAR_SPECIAL,
+    ['('] = CHAR_SPECIAL, [')'] = CHAR_SPECIAL, ['='] = CHAR_SPECIAL, [','] = CHAR_SPECIAL,
+    ['.'] = CHAR_SPECIAL, ['<'] = CHAR_SPECIAL, ['>'] = CHAR_SPECIAL, [';'] = CHAR_SPECIAL,
+    [':'] = CHAR_SPECIAL,
+
+    [' '] = CHAR_SPACE, ['\n'] = CHAR_SPACE, ['\r'] = CHAR_SPACE
+};
+
+/* ************************************************************************** */
+/* Scalar kernels *********************************************************** */
+/* ************************************************************************** */
+
+static size_t skipWhitespaceScalar(const char* text, size_t length, size_t from, int* lineNum)
+{
+    size_t i = from;
+
+    while(i < length && (charClasses[(unsigned char)text[i]] & CHAR_SPACE))
+    {
+        if(text[i] == '\n')
+            (*lineNum)++;
+        i++;
+    }
+
+    return i;
+}
+
+static size_t skipAlnumRunScalar(const char* text, size_t length, size_t from)
+{
+    size_t i = from;
+
+    while(i < length && (charClasses[(unsigned char)text[i]] & (CHAR_ALPHA | CHAR_DIGIT)))
+        i++;
+
+    return i;
+}
+
+static size_t skipDigitRunScalar(const char* text, size_t length, size_t from)
+{
+    size_t i = from;
+
+    while(i < length && (charClasses[(unsigned char)text[i]] & CHAR_DIGIT))
+        i++;
+
+    return i;
+}
+
+static size_t skipCommentBodyScalar(const char* text, size_t length, size_t from, int* lineNum)
+{
+    size_t i = from;
+
+    while(i < length)
+    {
+        if(text[i] == '\n')
+            (*lineNum)++;
+        else if(text[i] == '*' && i + 1 < length && text[i + 1] == '/')
+            return i + 2;
+        i++;
+    }
+
+    return length;
+}
+
+static const ScannerKernels scalarKernels = {
+    .name = "scalar",
+    .skipWhitespace = skipWhitespaceScalar,
+    .skipAlnumRun = skipAlnumRunScalar,
+    .skipDigitRun = skipDigitRunScalar,
+    .skipCommentBody = skipCommentBodyScalar
+};
+
+#if SCANNER_HAS_X86_SIMD
+
+/* ************************************************************************** */
+/* SSE2 kernels ************************************************************* */
+/* ************************************************************************** */
+
+/**
+ * Each kernel builds a bit mask of the characters that end the run in a
+ * .. block, consumes the block if the mask is empty, and otherwise stops at
+ * .. the lowest set bit. The remaining tail shorter than a block is handed
+ * .. to the scalar kernel.
+ * Letters are tested by folding to lower case and range checking with signed
+ * .. comparisons, which also reject the characters >= 0x80 since they are
+ * .. negative as signed bytes.
+ * */
+
+__attribute__((target("sse2")))
+static size_t skipWhitespaceSSE2(const char* text, size_t length, size_t from, int* lineNum)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newLine = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+    size_t i = from;
+
+    while(i + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i newLines = _mm_cmpeq_epi8(block, newLine);
+        __m128i spaces = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), newLines),
+                                      _mm_cmpeq_epi8(block, carriageReturn));
+
+        unsigned newLineMask = (unsigned)_mm_movemask_epi8(newLines);
+        unsigned stopMask = ~(unsigned)_mm_movemask_epi8(spaces) & 0xFFFFu;
+
+        if(stopMask)
+        {
+            unsigned stop = (unsigned)__builtin_ctz(stopMask);
+            *lineNum += __builtin_popcount(newLineMask & ((1u << stop) - 1));
+            return i + stop;
+        }
+
+        *lineNum += __builtin_popcount(newLineMask);
+        i += 16;
+    }
+
+    return skipWhitespaceScalar(text, length, i, lineNum);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i isAlnumSSE2(__m128i block)
+{
+    __m128i lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), block));
+
+    return _mm_or_si128(alpha, digit);
+}
+
+__attribute__((target("sse2")))
+static size_t skipAlnumRunSSE2(const char* text, size_t length, size_t from)
+{
+    size_t i = from;
+
+    while(i + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        unsigned stopMask = ~(unsigned)_mm_movemask_epi8(isAlnumSSE2(block)) & 0xFFFFu;
+
+        if(stopMask)
+            return i + (unsigned)__builtin_ctz(stopMask);
+
+        i += 16;
+    }
+
+    return skipAlnumRunScalar(text, length, i);
+}
+
+__attribute__((target("sse2")))
+static size_t skipDigitRunSSE2(const char* text, size_t length, size_t from)
+{
+    size_t i = from;
+
+    while(i + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), block));
+        unsigned stopMask = ~(unsigned)_mm_movemask_epi8(digit) & 0xFFFFu;
+
+        if(stopMask)
+            return i + (unsigned)__builtin_ctz(stopMask);
+
+        i += 16;
+    }
+
+    return skipDigitRunScalar(text, length, i);
+}
+
+__attribute__((target("sse2")))
+static size_t skipCommentBodySSE2(const char* text, size_t length, size_t from, int* lineNum)
+{
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i newLine = _mm_set1_epi8('\n');
+
+    size_t i = from;
+
+    // The block starting one character later supplies the character that
+    // .. follows each '*'
+    while(i + 17 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i nextBlock = _mm_loadu_si128((const __m128i*)(text + i + 1));
+
+        unsigned newLineMask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newLine));
+        unsigned endMask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block, star),
+                                                                     _mm_cmpeq_epi8(nextBlock, slash)));
+
+        if(endMask)
+        {
+            unsigned end = (unsigned)__builtin_ctz(endMask);
+            *lineNum += __builtin_popcount(newLineMask & ((1u << end) - 1));
+            return i + end + 2;
+        }
+
+        *lineNum += __builtin_popcount(newLineMask);
+        i += 16;
+    }
+
+    return skipCommentBodyScalar(text, length, i, lineNum);
+}
+
+static const ScannerKernels sse2Kernels = {
+    .name = "sse2",
+    .skipWhitespace = skipWhitespaceSSE2,
+    .skipAlnumRun = skipAlnumRunSSE2,
+    .skipDigitRun = skipDigitRunSSE2,
+    .skipCommentBody = skipCommentBodySSE2
+};
+
+/* ************************************************************************** */
+/* AVX2 kernels ************************************************************* */
+/* ************************************************************************** */
+
+__attribute__((target("avx2")))
+static size_t skipWhitespaceAVX2(const char* text, size_t length, size_t from, int* lineNum)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i newLine = _mm256_set1_epi8('\n');
+    const __m256i carriageReturn = _mm256_set1_epi8('\r');
+
+    size_t i = from;
+
+    while(i + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i newLines = _mm256_cmpeq_epi8(block, newLine);
+        __m256i spaces = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), newLines),
+                                         _mm256_cmpeq_epi8(block, carriageReturn));
+
+        unsigned newLineMask = (unsigned)_mm256_movemask_epi8(newLines);
+        unsigned stopMask = ~(unsigned)_mm256_movemask_epi8(spaces);
+
+        if(stopMask)
+        {
+            unsigned stop = (unsigned)__builtin_ctz(stopMask);
+            *lineNum += __builtin_popcount(newLineMask & ((1u << stop) - 1));
+            return i + stop;
+        }
+
+        *lineNum += __builtin_popcount(newLineMask);
+        i += 32;
+    }
+
+    return skipWhitespaceSSE2(text, length, i, lineNum);
+}
+
+__attribute__((target("avx2")))
+static size_t skipAlnumRunAVX2(const char* text, size_t length, size_t from)
+{
+    size_t i = from;
+
+    while(i + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i lower = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), block));
+        unsigned stopMask = ~(unsigned)_mm256_movemask_epi8(_mm256_or_si256(alpha, digit));
+
+        if(stopMask)
+            return i + (unsigned)__builtin_ctz(stopMask);
+
+        i += 32;
+    }
+
+    return skipAlnumRunSSE2(text, length, i);
+}
+
+__attribute__((target("avx2")))
+static size_t skipDigitRunAVX2(const char* text, size_t length, size_t from)
+{
+    size_t i = from;
+
+    while(i + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), block));
+        unsigned stopMask = ~(unsigned)_mm256_movemask_epi8(digit);
+
+        if(stopMask)
+            return i + (unsigned)__builtin_ctz(stopMask);
+
+        i += 32;
+    }
+
+    return skipDigitRunSSE2(text, length, i);
+}
+
+__attribute__((target("avx2")))
+static size_t skipCommentBodyAVX2(const char* text, size_t length, size_t from, int* lineNum)
+{
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    const __m256i newLine = _mm256_set1_epi8('\n');
+
+    size_t i = from;
+
+    while(i + 33 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i nextBlock = _mm256_loadu_si256((const __m256i*)(text + i + 1));
+
+        unsigned newLineMask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newLine));
+        unsigned endMask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block, star),
+                                                                           _mm256_cmpeq_epi8(nextBlock, slash)));
+
+        if(endMask)
+        {
+            unsigned end = (unsigned)__builtin_ctz(endMask);
+            *lineNum += __builtin_popcount(newLineMask & ((1u << end) - 1));
+            return i + end + 2;
+        }
+
+        *lineNum += __builtin_popcount(newLineMask);
+        i += 32;
+    }
+
+    return skipCommentBodySSE2(text, length, i, lineNum);
+}
+
+static const ScannerKernels avx2Kernels = {
+    .name = "avx2",
+    .skipWhitespace = skipWhitespaceAVX2,
+    .skipAlnumRun = skipAlnumRunAVX2,
+    .skipDigitRun = skipDigitRunAVX2,
+    .skipCommentBody = skipCommentBodyAVX2
+};
+
+#endif
+
+const ScannerKernels* getScannerKernels(ScannerLevel level)
+{
+    if(level == SCANNER_AUTO)
+    {
+        const char* forced = getenv("PL0_SCANNER");
+
+             if(forced && !strcmp(forced, "scalar")) level = SCANNER_SCALAR;
+        else if(forced && !strcmp(forced, "sse2"))   level = SCANNER_SSE2;
+        else                                         level = SCANNER_AVX2;
+    }
+
+#if SCANNER_HAS_X86_SIMD
+    if(level == SCANNER_AVX2 && __builtin_cpu_supports("avx2"))
+        return &avx2Kernels;
+
+    if(level >= SCANNER_SSE2 && __builtin_cpu_supports("sse2"))
+        return &sse2Kernels;
+#endif
+
+    return &scalarKernels;
+}
@@ -0,0 +1,75 @@
+#ifndef __SCANNER_H__
+#define __SCANNER_H__
+
+#include <stddef.h>
+
+/**
+ * Character classes of the PL/0 source code characters. A character belongs
+ * .. to at most one class; characters of no class are invalid.
+ * */
+enum {
+    CHAR_ALPHA   = 1, // a, b, .. , z, A, B, .. Z
+    CHAR_DIGIT   = 2, // 0, 1, .. , 9
+    CHAR_SPECIAL = 4, // '>', '=', , .. , ';', ':'
+    CHAR_SPACE   = 8  // ' ', '\n', '\r'
+};
+
+/**
+ * The class of each character, indexed by the character as unsigned char.
+ * */
+extern const unsigned char charClasses[256];
+
+/**
+ * The scanning kernels used by the lexer to consume runs of characters. Each
+ * .. kernel starts at index from of the text, never reads at or beyond
+ * .. length, and returns the index of the first character it did not consume.
+ * There is a scalar implementation of every kernel, and SSE2/AVX2 ones that
+ * .. process 16/32 characters at a time where the CPU supports them.
+ * */
+typedef struct {
+    const char* name;
+
+    /**
+     * Skips spaces and new lines. Adds the number of new lines skipped to
+     * .. *lineNum.
+     * */
+    size_t (*skipWhitespace)(const char* text, size_t length, size_t from, int* lineNum);
+
+    /**
+     * Skips letters and digits.
+     * */
+    size_t (*skipAlnumRun)(const char* text, size_t length, size_t from);
+
+    /**
+     * Skips digits.
+     * */
+    size_t (*skipDigitRun)(const char* text, size_t length, size_t from);
+
+    /**
+     * Skips the body of a comment up to and including the "*" "/" terminator,
+     * .. or up to length if the comment is not terminated. Adds the number of
+     * .. new lines skipped to *lineNum.
+     * */
+    size_t (*skipCommentBody)(const char* text, size_t length, size_t from, int* lineNum);
+} ScannerKernels;
+
+/**
+ * Implementations of the scanning kernels.
+ * */
+typedef enum {
+    SCANNER_AUTO,   // the fastest implementation the CPU supports
+    SCANNER_SCALAR,
+    SCANNER_SSE2,
+    SCANNER_AVX2
+} ScannerLevel;
+
+/**
+ * Returns the kernels of the given implementation. If the CPU does not
+ * .. support it, falls back to the next fastest supported implementation.
+ * For SCANNER_AUTO, the PL0_SCANNER environment variable ("scalar", "sse2"
+ * .. or "avx2") can be used to force an implementation, e.g. for benchmarks.
+ * The returned kernels are immutable and safe to share between threads.
+ * */
+const ScannerKernels* getScannerKernels(ScannerLevel level);
+
+#endif
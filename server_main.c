@@ -0,0 +1,53 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "compile_server.h"
+
+int main(int argc, char **argv)
+{
+    // The cache is kept in the working directory unless told otherwise
+    const char* cacheDirectory = ".pl0_cache";
+
+    /**********************************/
+    /* Parse Command Line Arguments */
+    /**********************************/
+    // Options come before the socket path
+    while(argc > 2)
+    {
+        if(!strcmp(argv[1], "--cache-dir") && argc > 3)
+        {
+            cacheDirectory = argv[2];
+            argc--;
+            argv++;
+        }
+        else
+        {
+            break;
+        }
+
+        argc--;
+        argv++;
+    }
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "Usage: ./pl0_server [--cache-dir dir] (socket_path)\n");
+
+        fprintf(stderr, "\n       Serves compilations on a Unix domain socket until interrupted. Run code_generator.out or pl0 with --server socket_path to compile through it.\n");
+
+        fprintf(stderr, "\n       --cache-dir: The directory of the compilation cache, created if missing. The outputs are stored by a hash of the input and the options, so unchanged inputs are never compiled twice. Defaults to %s.\n", cacheDirectory);
+
+        fprintf(stderr, "\n       socket_path: The path of the socket to listen on.\n");
+        return -1;
+    }
+
+    if(mkdir(cacheDirectory, 0777) && errno != EEXIST)
+    {
+        fprintf(stderr, "Could not create the cache directory \"%s\": %s\n", cacheDirectory, strerror(errno));
+        return -1;
+    }
+
+    return serveCompilations(argv[1], cacheDirectory);
+}
@@ -1,55 +1,125 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "source_code.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
-char* readSourceCode(FILE * inp)
+/**
+ * Reads the rest of the stream into a single allocation. The allocation is
+ * .. grown geometrically, so reading n characters costs O(n) in total.
+ * sizeHint is used as the initial capacity when it is known.
+ * If the stream cannot be read entirely, nothing is returned rather than the
+ * .. part that was read, so that a truncated program is never compiled.
+ * */
+static SourceCode readSourceCodeFromStream(FILE* inp, size_t sizeHint)
 {
-    if(!inp)
-        return NULL;
+    SourceCode sourceCode = { .text = NULL, .length = 0, .mapping = NULL, .mappingLength = 0 };
 
-    // How much chars should be added when the allocated
-    // .. space gets full
-    const int charCountAdvanceAmount = 10;
+    // How many chars should be allocated on the first read
+    const size_t initialCharCount = 4096;
 
-    // Initially, no space is allocated
-    int allocatedCharCount = 0;
-    char* sourceCode = NULL;
+    size_t allocatedCharCount = sizeHint > 0 ? sizeHint : initialCharCount;
+    char* buffer = (char*)malloc(allocatedCharCount);
+    if(!buffer) return sourceCode;
 
-    // Index to be filled by the newly read character
-    int nextCharInd = 0;
+    size_t charCount = 0;
+    size_t readCount;
 
-    char currentChar;
-    while( (currentChar = fgetc(inp)) != EOF )
+    while( (readCount = fread(buffer + charCount, 1, allocatedCharCount - charCount, inp)) > 0 )
     {
-        while(allocatedCharCount <= nextCharInd + 1)
+        charCount += readCount;
+
+        if(charCount == allocatedCharCount)
         {
-            allocatedCharCount += charCountAdvanceAmount;
-            sourceCode = (char*)realloc(sourceCode, allocatedCharCount * sizeof(char));
+            char* grown = (char*)realloc(buffer, allocatedCharCount * 2);
+
+            if(!grown)
+            {
+                fprintf(stderr, "Could not allocate space for the source code.\n");
+                free(buffer);
+                return sourceCode;
+            }
+
+            buffer = grown;
+            allocatedCharCount *= 2;
         }
+    }
 
-        sourceCode[nextCharInd++] = currentChar;
+    if(charCount == 0 || ferror(inp))
+    {
+        free(buffer);
+        return sourceCode;
     }
 
-    // Put terminator character at the end - if applicable
-    if(sourceCode) sourceCode[nextCharInd++] = '\0';
+    sourceCode.text = buffer;
+    sourceCode.length = charCount;
 
     return sourceCode;
 }
 
-void deleteSourceCode(char* sourceCode)
+SourceCode readSourceCode(FILE * inp)
 {
-    if(sourceCode)
-        free(sourceCode);
+    SourceCode sourceCode = { .text = NULL, .length = 0, .mapping = NULL, .mappingLength = 0 };
+
+    if(!inp)
+        return sourceCode;
+
+    struct stat fileStat;
+    int fd = fileno(inp);
+
+    // Streams whose size is not known up front can only be read
+    if(fd < 0 || fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+        return readSourceCodeFromStream(inp, 0);
+
+    // Map the whole file, and start the view from the current position of
+    // .. the stream since mmap requires a page aligned offset
+    long offset = ftell(inp);
+    if(offset < 0) offset = 0;
+
+    if((off_t)offset >= fileStat.st_size)
+        return sourceCode;
+
+    size_t fileSize = (size_t)fileStat.st_size;
+    void* mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(mapping == MAP_FAILED)
+        return readSourceCodeFromStream(inp, fileSize - (size_t)offset);
+
+    // The lexer reads the source front to back exactly once
+    posix_madvise(mapping, fileSize, POSIX_MADV_SEQUENTIAL);
+
+    sourceCode.mapping = mapping;
+    sourceCode.mappingLength = fileSize;
+    sourceCode.text = (const char*)mapping + offset;
+    sourceCode.length = fileSize - (size_t)offset;
+
+    return sourceCode;
 }
 
-void printSourceCode(char* sourceCode)
+void deleteSourceCode(SourceCode* sourceCode)
 {
     if(!sourceCode)
         return;
 
-    int i = 0;
-    while(sourceCode[i++] != '\0')
-    {
-        printf("%c", sourceCode[i]);
-    }
-}
\ No newline at end of file
+    if(sourceCode->mapping)
+        munmap(sourceCode->mapping, sourceCode->mappingLength);
+    else if(sourceCode->text)
+        free((char*)sourceCode->text);
+
+    sourceCode->text = NULL;
+    sourceCode->length = 0;
+    sourceCode->mapping = NULL;
+    sourceCode->mappingLength = 0;
+}
+
+void printSourceCode(SourceCode sourceCode)
+{
+    if(!sourceCode.text)
+        return;
+
+    fwrite(sourceCode.text, 1, sourceCode.length, stdout);
+}
@@ -2,21 +2,41 @@
 #define __SOURCE_CODE_H__
 
 #include <stdio.h>
+#include <stddef.h>
 
 /**
- * Reads the source code from file until EOF to a null-terminated string.
+ * A read-only view of the source code. The characters are NOT null-terminated;
+ * .. length is the only valid bound on text.
+ * Depending on the input, text either points into a memory mapping of the
+ * .. input file or into a single heap allocation. Either way, the storage
+ * .. is owned by the SourceCode and released by deleteSourceCode().
  * */
-char* readSourceCode(FILE*);
+typedef struct {
+    const char* text;     // source characters, NULL if nothing could be read
+    size_t length;        // number of characters in text
+    void* mapping;        // base of the memory mapping, NULL if heap allocated
+    size_t mappingLength; // length of the memory mapping in bytes
+} SourceCode;
 
 /**
- * Prints the source code - simply prints a string.
+ * Reads the source code from the current position of the file until EOF.
+ * Regular files are memory mapped, so no copying of the characters is done.
+ * For other streams, such as pipes or stdin, the characters are read into a
+ * .. single growing allocation.
+ * If the file is NULL, empty or cannot be read entirely, the text field of
+ * .. the result is NULL.
  * */
-void printSourceCode(char*);
+SourceCode readSourceCode(FILE*);
 
 /**
- * Deallocates the memory dynamically allocated for source code string
- * .. - simply calls free on the pointer.
+ * Prints the source code to stdout.
  * */
-void deleteSourceCode(char*);
+void printSourceCode(SourceCode);
 
-#endif
\ No newline at end of file
+/**
+ * Releases the storage of the source code - either unmaps the file or
+ * .. frees the allocation - and resets the view to empty.
+ * */
+void deleteSourceCode(SourceCode*);
+
+#endif
@@ -2,34 +2,241 @@
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * Makes sure that the array can hold at least required elements, growing its
+ * .. capacity geometrically. Returns 0 on success, -1 if the allocation fails.
+ * */
+static int reserveArray(void** array, int* capacity, int required, size_t elementSize)
+{
+    if(required <= *capacity) return 0;
+
+    int newCapacity = *capacity ? 2 * *capacity : 16;
+    while(newCapacity < required) newCapacity *= 2;
+
+    void* grown = realloc(*array, (size_t)newCapacity * elementSize);
+    if(!grown) return -1;
+
+    *array = grown;
+    *capacity = newCapacity;
+
+    return 0;
+}
+
+/**
+ * Hashes the null-terminated name (FNV-1a).
+ * */
+static unsigned int hashName(const char* name)
+{
+    unsigned int hash = 2166136261u;
+
+    for(; *name; name++)
+        hash = (hash ^ (unsigned char)*name) * 16777619u;
+
+    return hash;
+}
+
+/**
+ * Returns the hash table slot of the given name: either the slot holding it,
+ * .. or the empty slot where it would be inserted.
+ * */
+static int findNameSlot(SymbolTable* symbolTable, const char* name)
+{
+    int mask = symbolTable->nameSlotCount - 1;
+    int slot = hashName(name) & mask;
+
+    while(symbolTable->nameSlots[slot])
+    {
+        SymbolName* symbolName = &symbolTable->names[symbolTable->nameSlots[slot] - 1];
+
+        if(!strcmp(getSymbol(symbolTable, symbolName->firstSymbol)->name, name))
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Doubles the number of hash table slots and reinserts the names.
+ * Returns 0 on success, -1 if the allocation fails.
+ * */
+static int growNameSlots(SymbolTable* symbolTable)
+{
+    int slotCount = symbolTable->nameSlotCount ? 2 * symbolTable->nameSlotCount : 64;
+    int* slots = (int*)calloc(slotCount, sizeof(int));
+    if(!slots) return -1;
+
+    free(symbolTable->nameSlots);
+    symbolTable->nameSlots = slots;
+    symbolTable->nameSlotCount = slotCount;
+
+    for(int nameId = 0; nameId < symbolTable->numberOfNames; nameId++)
+    {
+        const char* name = getSymbol(symbolTable, symbolTable->names[nameId].firstSymbol)->name;
+        slots[findNameSlot(symbolTable, name)] = nameId + 1;
+    }
+
+    return 0;
+}
+
 void initSymbolTable(SymbolTable* symbolTable)
 {
-    symbolTable->symbols = NULL;
+    symbolTable->chunks = NULL;
+    symbolTable->numberOfChunks = 0;
+    symbolTable->chunkCapacity = 0;
     symbolTable->numberOfSymbols = 0;
+
+    symbolTable->names = NULL;
+    symbolTable->numberOfNames = 0;
+    symbolTable->nameCapacity = 0;
+
+    symbolTable->nameSlots = NULL;
+    symbolTable->nameSlotCount = 0;
+
+    symbolTable->scopes = NULL;
+    symbolTable->numberOfScopes = 0;
+    symbolTable->scopeCapacity = 0;
+    symbolTable->currentScope = GLOBAL_SCOPE;
+
+    // Open the global scope
+    if(reserveArray((void**)&symbolTable->scopes, &symbolTable->scopeCapacity, 1, sizeof(Scope)))
+    {
+        fprintf(stderr, "Could not allocate space for the global scope.\n");
+        return;
+    }
+
+    symbolTable->scopes[GLOBAL_SCOPE] = (Scope){ .parent = -1, .owner = NULL, .lastSymbol = -1 };
+    symbolTable->numberOfScopes = 1;
 }
 
 void deleteSymbolTable(SymbolTable* symbolTable)
 {
     if(!symbolTable) return;
 
-    if(symbolTable->symbols)
-        free(symbolTable->symbols);
+    for(int i = 0; i < symbolTable->numberOfChunks; i++)
+        free(symbolTable->chunks[i]);
+
+    free(symbolTable->chunks);
+    free(symbolTable->names);
+    free(symbolTable->nameSlots);
+    free(symbolTable->scopes);
 
-    symbolTable->symbols = NULL;
+    symbolTable->chunks = NULL;
+    symbolTable->numberOfChunks = 0;
+    symbolTable->chunkCapacity = 0;
     symbolTable->numberOfSymbols = 0;
+
+    symbolTable->names = NULL;
+    symbolTable->numberOfNames = 0;
+    symbolTable->nameCapacity = 0;
+
+    symbolTable->nameSlots = NULL;
+    symbolTable->nameSlotCount = 0;
+
+    symbolTable->scopes = NULL;
+    symbolTable->numberOfScopes = 0;
+    symbolTable->scopeCapacity = 0;
+    symbolTable->currentScope = GLOBAL_SCOPE;
+}
+
+int pushScope(SymbolTable* symbolTable, const Symbol* owner)
+{
+    if(!symbolTable || !symbolTable->numberOfScopes) return -1;
+
+    int scopeId = symbolTable->numberOfScopes;
+
+    if(reserveArray((void**)&symbolTable->scopes, &symbolTable->scopeCapacity, scopeId + 1, sizeof(Scope)))
+    {
+        fprintf(stderr, "Could not allocate space for %d scopes.\n", scopeId + 1);
+        return -1;
+    }
+
+    symbolTable->scopes[scopeId] = (Scope){ .parent = symbolTable->currentScope, .owner = owner, .lastSymbol = -1 };
+    symbolTable->numberOfScopes++;
+    symbolTable->currentScope = scopeId;
+
+    return scopeId;
+}
+
+void popScope(SymbolTable* symbolTable)
+{
+    if(!symbolTable || symbolTable->currentScope == GLOBAL_SCOPE) return;
+
+    Scope* scope = &symbolTable->scopes[symbolTable->currentScope];
+
+    // Restore the bindings the symbols of the scope have hidden
+    for(int i = scope->lastSymbol; i != -1; i = getSymbol(symbolTable, i)->previousInScope)
+    {
+        Symbol* symbol = getSymbol(symbolTable, i);
+        symbolTable->names[symbol->nameId].binding = symbol->shadowed;
+    }
+
+    symbolTable->currentScope = scope->parent;
+}
+
+Symbol* getSymbol(SymbolTable* symbolTable, int symbolInd)
+{
+    return &symbolTable->chunks[symbolInd >> SYMBOL_CHUNK_BITS][symbolInd & (SYMBOL_CHUNK_SIZE - 1)];
 }
 
 Symbol* addSymbol(SymbolTable* symbolTable, Symbol symbol)
 {
-    if(!symbolTable) return NULL;
+    if(!symbolTable || !symbolTable->numberOfScopes) return NULL;
 
-    symbolTable->numberOfSymbols++;
+    int symbolInd = symbolTable->numberOfSymbols;
 
-    symbolTable->symbols = (Symbol*)realloc(symbolTable->symbols, (symbolTable->numberOfSymbols) * sizeof(Symbol));
+    // Start a new chunk when the last one is full. Only the array of chunk
+    // .. pointers is reallocated; the symbols themselves never move.
+    if(symbolInd == symbolTable->numberOfChunks * SYMBOL_CHUNK_SIZE)
+    {
+        if(reserveArray((void**)&symbolTable->chunks, &symbolTable->chunkCapacity,
+            symbolTable->numberOfChunks + 1, sizeof(Symbol*)))
+        {
+            return NULL;
+        }
+
+        Symbol* chunk = (Symbol*)malloc(SYMBOL_CHUNK_SIZE * sizeof(Symbol));
+        if(!chunk) return NULL;
+
+        symbolTable->chunks[symbolTable->numberOfChunks++] = chunk;
+    }
 
-    symbolTable->symbols[symbolTable->numberOfSymbols - 1] = symbol;
+    // The spelling of a new name is the name of this symbol, so the symbol
+    // .. is stored before the name is interned
+    Symbol* added = getSymbol(symbolTable, symbolInd);
+    *added = symbol;
 
-    return &symbolTable->symbols[symbolTable->numberOfSymbols - 1];
+    if(2 * (symbolTable->numberOfNames + 1) > symbolTable->nameSlotCount && growNameSlots(symbolTable))
+        return NULL;
+
+    int slot = findNameSlot(symbolTable, symbol.name);
+
+    if(!symbolTable->nameSlots[slot])
+    {
+        if(reserveArray((void**)&symbolTable->names, &symbolTable->nameCapacity,
+            symbolTable->numberOfNames + 1, sizeof(SymbolName)))
+        {
+            return NULL;
+        }
+
+        symbolTable->names[symbolTable->numberOfNames] = (SymbolName){ .firstSymbol = symbolInd, .binding = -1 };
+        symbolTable->nameSlots[slot] = ++symbolTable->numberOfNames;
+    }
+
+    Scope* scope = &symbolTable->scopes[symbolTable->currentScope];
+    SymbolName* name = &symbolTable->names[symbolTable->nameSlots[slot] - 1];
+
+    added->scope = symbolTable->currentScope;
+    added->nameId = symbolTable->nameSlots[slot] - 1;
+    added->shadowed = name->binding;
+    added->previousInScope = scope->lastSymbol;
+
+    name->binding = symbolInd;
+    scope->lastSymbol = symbolInd;
+    symbolTable->numberOfSymbols++;
+
+    return added;
 }
 
 void printSymbolTable(SymbolTable* symbolTable, FILE* out)
@@ -42,7 +249,7 @@ void printSymbolTable(SymbolTable* symbolTable, FILE* out)
     {
         fprintf(out, "#%d\n", i);
 
-        Symbol* symbol = &(symbolTable->symbols[i]);
+        Symbol* symbol = getSymbol(symbolTable, i);
 
         switch(symbol->type)
         {
@@ -74,44 +281,26 @@ void printSymbolTable(SymbolTable* symbolTable, FILE* out)
 
         // Print backtrace of scope
         fprintf(out, "  Scope: ");
-        Symbol* scope = symbol->scope;
-        while(scope != NULL)
+        int scope = symbol->scope;
+        while(scope != GLOBAL_SCOPE)
         {
-            fprintf(out, "%s -> ", scope->name);
-            scope = scope->scope;
+            const Symbol* owner = symbolTable->scopes[scope].owner;
+            fprintf(out, "%s -> ", owner ? owner->name : "?");
+            scope = symbolTable->scopes[scope].parent;
         }
         fprintf(out, "GLOBAL\n\n");
     }
 }
 
-Symbol* findSymbol(SymbolTable* symbolTable, Symbol* scope, const char* symbolName)
+Symbol* findSymbol(SymbolTable* symbolTable, const char* symbolName)
 {
-    if(!symbolTable || !symbolName) return NULL;
+    if(!symbolTable || !symbolName || !symbolTable->nameSlotCount) return NULL;
 
-    // Search from the most inner scope to global scope
-    while(1)
-    {
-        // Search the current scope
-        for(int i = 0; i < symbolTable->numberOfSymbols; i++)
-        {
-            if( symbolTable->symbols[i].scope == scope && !strcmp(symbolTable->symbols[i].name, symbolName) )
-            {
-                return &symbolTable->symbols[i];
-            }
-        }
+    int nameId = symbolTable->nameSlots[findNameSlot(symbolTable, symbolName)] - 1;
 
-        if(!scope)
-        {
-            /**
-             * All symbols from the most inner scope to global scope are searched.
-             * However, the symbol is not found. 
-             * */
-            return NULL;
-        } else
-        {
-            // Change the scope to the outer scope
-            scope = scope->scope;
-        }
-    }
+    // Either the name was never declared, or none of its symbols is visible
+    if(nameId == -1 || symbolTable->names[nameId].binding == -1)
+        return NULL;
 
-}
\ No newline at end of file
+    return getSymbol(symbolTable, symbolTable->names[nameId].binding);
+}
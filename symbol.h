@@ -22,6 +22,7 @@ typedef enum
  * level  : CONST, VAR, PROC
  * address: VAR, PROC
  * scope  : CONST, VAR, PROC
+ * The scope and the remaining fields are set by addSymbol().
  * */
 
 typedef struct Symbol Symbol;
@@ -32,15 +33,69 @@ struct Symbol {
 	int value;
 	unsigned int level;
     unsigned int address;
-    Symbol* scope;
+    int scope; // id of the scope the symbol is declared in, GLOBAL_SCOPE or a pushScope() result
+
+    int nameId;          // interned name of the symbol
+    int shadowed;        // index of the symbol with the same name it hides, -1 if none
+    int previousInScope; // index of the previous symbol of the same scope, -1 if none
 };
 
+/**
+ * The id of the global scope, which is open as long as the symbol table exists.
+ * */
+#define GLOBAL_SCOPE 0
+
+/**
+ * Symbols are stored in fixed size chunks that are never moved, so a Symbol*
+ * .. stays valid until the symbol table is deleted.
+ * */
+#define SYMBOL_CHUNK_BITS 8
+#define SYMBOL_CHUNK_SIZE (1 << SYMBOL_CHUNK_BITS)
+
+/**
+ * An interned name: every distinct symbol name is given a dense id.
+ * */
+typedef struct {
+    int firstSymbol; // index of the first symbol with this name, holds the spelling
+    int binding;     // index of the innermost visible symbol with this name, -1 if none
+} SymbolName;
+
+/**
+ * A scope: the global scope or the block of a procedure.
+ * */
+typedef struct {
+    int parent;          // id of the enclosing scope, -1 for the global scope
+    const Symbol* owner; // the procedure whose block the scope is, NULL for the global scope
+    int lastSymbol;      // index of the last symbol added to the scope, -1 if none
+} Scope;
+
 /**
  * Symbol table.
+ * Symbols are never removed; closing a scope only hides its symbols. Names are
+ * .. interned through a hash table, and each name is bound to its innermost
+ * .. visible symbol, so looking a name up takes O(1) expected time regardless
+ * .. of the number of symbols and the depth of the scopes.
  * */
 typedef struct {
-    Symbol* symbols;
+    Symbol** chunks;
+    int numberOfChunks;
+    int chunkCapacity;
     int numberOfSymbols;
+
+    SymbolName* names;
+    int numberOfNames;
+    int nameCapacity;
+
+    // Open addressing hash table of the names, at most half full. Each slot
+    // .. holds the id of a name plus one, or 0 if the slot is empty.
+    int* nameSlots;
+    int nameSlotCount;
+
+    // All the scopes ever opened, indexed by scope id
+    Scope* scopes;
+    int numberOfScopes;
+    int scopeCapacity;
+    int currentScope; // id of the innermost open scope
 } SymbolTable;
 
 /**
@@ -55,20 +110,43 @@ void initSymbolTable(SymbolTable*);
 void deleteSymbolTable(SymbolTable*);
 
 /**
- * Appends a copy of the given symbol to the given symbol table.
+ * Opens a new scope nested in the current one, for the block of the given
+ * .. procedure. Symbols added afterwards belong to the new scope and hide the
+ * .. symbols of the enclosing scopes with the same name.
+ * Returns the id of the new scope, -1 if it could not be opened.
+ * */
+int pushScope(SymbolTable*, const Symbol* owner);
+
+/**
+ * Closes the innermost scope: its symbols are no longer found by findSymbol(),
+ * .. and the symbols they hid are visible again. Takes time proportional to
+ * .. the number of symbols of the closed scope. Does nothing on the global
+ * .. scope.
+ * */
+void popScope(SymbolTable*);
+
+/**
+ * Appends a copy of the given symbol to the given symbol table, in the
+ * .. innermost scope. Returns the stored symbol, or NULL if the symbol could
+ * .. not be added. Adding symbols never invalidates the returned pointers.
  * */
 Symbol* addSymbol(SymbolTable*, Symbol);
 
+/**
+ * Returns the symbol at the given index, in the order of addition.
+ * */
+Symbol* getSymbol(SymbolTable*, int symbolInd);
+
 /**
  * Given symbol table, prints the entries of symbol table to the given file.
  * */
 void printSymbolTable(SymbolTable*, FILE*);
 
 /**
- * In the given symbolTable, searches the symbol with symbolName.
- * Iteratively, the scopes are searched starting from the given scope to its
- * ancestors until the global scope (NULL) is reached.
+ * In the given symbolTable, searches the symbol with symbolName that is
+ * .. visible from the innermost scope, ie., the one declared in the innermost
+ * .. of the open scopes. Returns NULL if there is no such symbol.
  * */
-Symbol* findSymbol(SymbolTable* symbolTable, Symbol* scope, const char* symbolName);
+Symbol* findSymbol(SymbolTable* symbolTable, const char* symbolName);
 
 #endif
\ No newline at end of file
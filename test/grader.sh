@@ -1,23 +1,157 @@
 tests="tests.txt"
+faults="vm_faults.txt"
 cg="../code_generator.out"
 vm="../vm/vm.out"
+pl0="../pl0"
+server="../pl0_server"
 EMPH='\033[1;31m'
 GREEN_EMPH='\033[1;32m'
 DEEMPH='\033[0m'
 timeout=1s
 
+# In fusion-check mode, the generated code of every not_error case is run
+#   twice, with and without superinstructions (see vm.out --no-fusion). The
+#   test passes if both runs produce the same output and exit status, which
+#   checks the fused path against the unfused one regardless of whether the
+#   generated code is correct. error cases are skipped.
+fusion_check=0
+if [ "$1" = "--fusion-check" ]; then
+    fusion_check=1
+fi
+
+# In opt-check mode, the code of every not_error case is generated again with
+#   each optimization of opt_flags turned off, and run. The test passes if
+#   every run produces the same output and exit status as the optimized one,
+#   and the optimized code is not longer. An optimization named in the
+#   optimized.txt next to the lexer out of a case must make its code
+#   strictly shorter. error cases are skipped.
+opt_check=0
+opt_flags="--no-dead-code-elimination --no-peephole"
+if [ "$1" = "--opt-check" ]; then
+    opt_check=1
+fi
+
+# In pl0 mode, every case is compiled and run by the single pl0 driver from
+#   the pl0_code.txt next to its lexer out, instead of by code_generator.out
+#   and vm.out. The errors the driver writes to stderr are graded as cg_out.
+pl0_mode=0
+if [ "$1" = "--pl0" ]; then
+    pl0_mode=1
+fi
+
+# In binary-code mode, the code generator writes binary PM/0 objects (see
+#   code_generator.out --binary-code), which vm.out loads instead of the
+#   text code. Errors are still written as text, so every case is graded
+#   as usual.
+cg_flags=""
+if [ "$1" = "--binary-code" ]; then
+    cg_flags="--binary-code"
+fi
+
+# In vm-faults mode, the hand-written PM/0 programs of vm_faults.txt, which
+#   the code generator never emits, are run by vm.out both with --fast and
+#   with the trace. A case passes if both runs fail with the expected output
+#   and the expected fault report. Each line of vm_faults.txt is
+#   "pm0_code vm_inp vm_out gt_vm_out gt_vm_err [vm flags]", where vm_out
+#   names the outputs of the runs. A case run with --max-steps checks that
+#   both runs stop at the same instruction, with the same output.
+vm_faults=0
+if [ "$1" = "--vm-faults" ]; then
+    vm_faults=1
+fi
+
+# In server mode, every case is compiled twice through a pl0_server with an
+#   empty cache (see code_generator.out --server), then graded as usual. A
+#   case passes if the first run adds the output to the cache, the second
+#   run is answered from the cache with the same output, and the output is
+#   the expected one. The server is stopped after the last case, and its
+#   summary has to count every second run as cached.
+server_mode=0
+if [ "$1" = "--server" ]; then
+    server_mode=1
+fi
+
 i=0
 passed=0
 failed=0
 
 # check if cg.out, vm.out and tests_grader.txt exists
-if [[ -e $cg && -e $vm && -e $tests ]] ; then
+if [[ $pl0_mode -eq 1 && ! -e $pl0 ]] ; then
+    echo "$pl0 could not be found! Aborting.."
+    exit
+elif [[ -e $cg && -e $vm && -e $tests ]] ; then
     echo "$cg, $vm and $tests are found. Starting tests.."
 else
     echo "$cg, $vm or $tests could not be found! Aborting.."
     exit
 fi
 
+if [ $server_mode -eq 1 ]; then
+  if [ ! -e $server ]; then
+    echo "$server could not be found! Aborting.."
+    exit
+  fi
+
+  server_dir=$(mktemp -d)
+  socket="$server_dir/socket"
+  cache_dir="$server_dir/cache"
+  mkdir "$cache_dir"
+  "$server" --cache-dir "$cache_dir" "$socket" > "$server_dir/summary.txt" 2>&1 &
+  server_pid=$!
+
+  for wait in $(seq 50); do
+    [ -S "$socket" ] && break
+    sleep 0.1
+  done
+fi
+
+if [ $vm_faults -eq 1 ]; then
+  while read pm0_code vm_inp vm_out gt_vm_out gt_vm_err vm_flags; do
+    echo -e "${GREEN_EMPH}TEST[$i]${DEEMPH}"
+    mkdir -p "$(dirname "$vm_out")"
+    _diff=""
+
+    for run in fast traced; do
+      run_out="${vm_out%.txt}_$run.txt"
+      run_err="${vm_out%.txt}_${run}_err.txt"
+
+      if [ $run = fast ]; then
+        (timeout $timeout "$vm" --fast $vm_flags "$pm0_code" /dev/null "$vm_inp" "$run_out") > /dev/null 2> "$run_err"
+      else
+        (timeout $timeout "$vm" $vm_flags "$pm0_code" "${vm_out%.txt}_trace.txt" "$vm_inp" "$run_out") > /dev/null 2> "$run_err"
+      fi
+      status=$?
+
+      if [ $status -eq 0 ] || [ $status -eq 124 ]; then
+        _diff="$_diff the $run run exited with status $status instead of faulting."
+      fi
+      _diff="$_diff$( { diff -B -w $run_out $gt_vm_out; diff -B -w $run_err $gt_vm_err; } 2>&1 )"
+    done
+
+    if [[ $_diff ]] ; then
+      echo "TEST $i FAILED"
+      let failed=$failed+1
+      echo "The runs of $pm0_code differ from $gt_vm_out and $gt_vm_err:"
+      echo "=================================================================="
+      echo $_diff
+      echo "=================================================================="
+      echo -e "${EMPH}Test this yourself by running the following${DEEMPH}: "
+      echo "  (cd test/; ./$vm --fast $vm_flags $pm0_code /dev/null $vm_inp ${vm_out%.txt}_fast.txt)"
+      echo "  (cd test/; ./$vm $vm_flags $pm0_code ${vm_out%.txt}_trace.txt $vm_inp ${vm_out%.txt}_traced.txt)"
+      echo ""
+    else
+      echo "TEST $i PASSED"
+      let passed=$passed+1
+    fi
+    let i=$i+1
+  done < "$faults"
+
+  echo "# of tests       : $i"
+  echo "# of tests passed: $passed"
+  echo "# of tests failed: $failed"
+  exit
+fi
+
 # pl0_code, vm_inp and gt_vm_out will be given.
 # cg_out and vm_out is expected to be outputted by the pipeline and will be
 #   the files that are going to be graded.
@@ -45,29 +179,104 @@ while read is_err cg_in cg_out others; do
       exit 0
     fi
 
+    # skipped cases keep their number, so that it matches the line of $tests
+    if [[ ( $fusion_check -eq 1 || $opt_check -eq 1 ) && "$is_err" = "error" ]]; then
+      let i=$i+1
+      continue
+    fi
+
+    server_diff=""
+
     # create directories if needed
     out_dir=$(dirname "$cg_out")
     mkdir -p "$out_dir"
     out_dir=$(dirname "$vm_out")
     mkdir -p "$out_dir"
     
-    # run the code generator
-    (timeout $timeout "$cg" "$cg_in" "$cg_out") > /dev/null 2>&1
+    if [ $pl0_mode -eq 1 ]; then
+      # compile and run the source code in a single process
+      pl0_code="$(dirname "$cg_in")/pl0_code.txt"
+
+      if [ "$is_err" = "error" ]; then
+        (timeout $timeout "$pl0" "$pl0_code" /dev/null /dev/null) > /dev/null 2> "$cg_out"
+        _diff=$( { diff -B -w $cg_out $gt_cg_out; } 2>&1 )
+      else
+        (timeout $timeout "$pl0" "$pl0_code" "$vm_inp" "$vm_out") > /dev/null 2>&1
+        _diff=$( { diff -B -w $vm_out $gt_vm_out; } 2>&1 )
+      fi
+    else
+      # run the code generator
+      if [ $server_mode -eq 1 ]; then
+        # the entries of the cache tell whether a run was served from it
+        entries=$(ls "$cache_dir" | wc -l)
+        (timeout $timeout "$cg" --server "$socket" "$cg_in" "$cg_out") > /dev/null 2>&1
+        compiled_entries=$(ls "$cache_dir" | wc -l)
+        (timeout $timeout "$cg" --server "$socket" "$cg_in" "${cg_out%.txt}_cached.txt") > /dev/null 2>&1
+        cached_entries=$(ls "$cache_dir" | wc -l)
+
+        server_diff=$( { diff $cg_out ${cg_out%.txt}_cached.txt; } 2>&1 )
+        if [ $compiled_entries -ne $((entries + 1)) ]; then
+          server_diff="$server_diff the first run was not compiled by the server."
+        elif [ $cached_entries -ne $compiled_entries ]; then
+          server_diff="$server_diff the second run was not served from the cache."
+        fi
+      else
+        (timeout $timeout "$cg" $cg_flags "$cg_in" "$cg_out") > /dev/null 2>&1
+      fi
+
+      # if the error case is expected, then, do not run vm but just check the err
+      if [ "$is_err" = "error" ]; then
+        # check if the correct error code is produced
+        _diff=$( { diff -B -w $cg_out $gt_cg_out; } 2>&1 )
+
+      elif [ "$is_err" = "not_error" ]; then
+        # code should have been produced. therefore, run the vm.
+        (timeout $timeout "$vm" --fast "$cg_out" "/dev/null" "$vm_inp" "$vm_out") > /dev/null 2>&1
+        vm_status=$?
 
-    # if the error case is expected, then, do not run vm but just check the err
-    if [ "$is_err" = "error" ]; then
-      # check if the correct error code is produced
-      _diff=$( { diff -B -w $cg_out $gt_cg_out; } 2>&1 )
+        if [ $fusion_check -eq 1 ]; then
+          # compare against the output of the unfused run instead
+          gt_vm_out="${vm_out%.txt}_unfused.txt"
+          (timeout $timeout "$vm" --fast --no-fusion "$cg_out" "/dev/null" "$vm_inp" "$gt_vm_out") > /dev/null 2>&1
+          unfused_status=$?
 
-    elif [ "$is_err" = "not_error" ]; then
-      # code should have been produced. therefore, run the vm.
-      (timeout $timeout "$vm" "$cg_out" "/dev/null" "$vm_inp" "$vm_out") > /dev/null 2>&1
+          _diff=$( { diff $vm_out $gt_vm_out; } 2>&1 )
+          if [ $vm_status -ne $unfused_status ]; then
+            _diff="$_diff exit status $vm_status differs from $unfused_status without fusion"
+          fi
+        elif [ $opt_check -eq 1 ]; then
+          # compare against the code generated without each optimization
+          _diff=""
+          optimized_length=$(grep -c "" "$cg_out")
+          required="$(dirname "$cg_in")/optimized.txt"
 
-      # check if the correct vm_out is produced
-      _diff=$( { diff -B -w $vm_out $gt_vm_out; } 2>&1 )
+          for flag in $opt_flags; do
+            unopt_cg_out="${cg_out%.txt}_${flag#--}.txt"
+            unopt_vm_out="${vm_out%.txt}_${flag#--}.txt"
+            (timeout $timeout "$cg" $flag "$cg_in" "$unopt_cg_out") > /dev/null 2>&1
+            (timeout $timeout "$vm" --fast "$unopt_cg_out" "/dev/null" "$vm_inp" "$unopt_vm_out") > /dev/null 2>&1
+            unopt_status=$?
+            unopt_length=$(grep -c "" "$unopt_cg_out")
+
+            _diff="$_diff$( { diff $vm_out $unopt_vm_out; } 2>&1 )"
+            if [ $vm_status -ne $unopt_status ]; then
+              _diff="$_diff exit status $vm_status differs from $unopt_status with $flag."
+            fi
+            if [ $optimized_length -gt $unopt_length ]; then
+              _diff="$_diff $optimized_length instructions are more than the $unopt_length with $flag."
+            elif [[ -e "$required" && $optimized_length -eq $unopt_length ]] && grep -q -- "$flag" "$required"; then
+              _diff="$_diff no instructions are removed by the optimization that $flag turns off."
+            fi
+          done
+        else
+          # check if the correct vm_out is produced
+          _diff=$( { diff -B -w $vm_out $gt_vm_out; } 2>&1 )
+        fi
+      fi
     fi
-    
+
     # up to now, _diff should have been already set up
+    _diff="$server_diff$_diff"
     
     if [[ $_diff ]] ; then
         # sad.. difference found
@@ -92,8 +301,8 @@ while read is_err cg_in cg_out others; do
           echo "Your code generator was expected to output a PM0 code that would produce a certain"
           echo "output when it is run on the virtual machine."
           echo -e "${EMPH}Test this yourself by running the following${DEEMPH}: "
-          echo "  (cd test/; ./$cg $cg_in $cg_out)"
-          echo "  (cd test/; ./$vm $cg_out /dev/null $vm_inp $vm_out) "
+          echo "  (cd test/; ./$cg $cg_flags $cg_in $cg_out)"
+          echo "  (cd test/; ./$vm --fast $cg_out /dev/null $vm_inp $vm_out) "
           echo "The output is in \"test/$vm_out\". It was expected to match \"test/$gt_vm_out\"."
           echo ""
         fi
@@ -106,6 +315,25 @@ while read is_err cg_in cg_out others; do
 
 done < "$tests"
 
-echo "# of tests       : $i"
+if [ $server_mode -eq 1 ]; then
+  kill -TERM $server_pid
+  wait $server_pid
+
+  summary="Served $((2 * i)) compilations, $i of them from the cache."
+  if grep -q -F "$summary" "$server_dir/summary.txt"; then
+    echo "SERVER SUMMARY PASSED"
+    let passed=$passed+1
+  else
+    echo "SERVER SUMMARY FAILED"
+    let failed=$failed+1
+    echo "The server was expected to report \"$summary\", but reported:"
+    cat "$server_dir/summary.txt"
+    echo ""
+  fi
+
+  rm -rf "$server_dir"
+fi
+
+echo "# of tests       : $((passed + failed))"
 echo "# of tests passed: $passed"
 echo "# of tests failed: $failed"
@@ -0,0 +1,109 @@
+lexer="../lexical_analyzer.out"
+EMPH='\033[1;31m'
+GREEN_EMPH='\033[1;32m'
+DEEMPH='\033[0m'
+timeout=1s
+
+# In leak-check mode, the lexer instrumented with LeakSanitizer is run. It
+#   exits with a failure status if any memory allocated while lexing is not
+#   released, which fails the test even if the produced tokens are correct.
+leak_check=0
+if [ "$1" = "--leak-check" ]; then
+    leak_check=1
+    lexer="../lexical_analyzer_leak_check.out"
+    export ASAN_OPTIONS="detect_leaks=1:exitcode=23"
+fi
+
+# In binary-tokens mode, the lexer writes a binary token stream instead of
+#   the token table. As the stream is not human readable, it is checked by
+#   running the code generator on both the stream and the expected token
+#   table: the code generator outputs are expected to match.
+binary_tokens=0
+cg="../code_generator.out"
+if [ "$1" = "--binary-tokens" ]; then
+    binary_tokens=1
+    if [[ ! -e $cg ]] ; then
+        echo "$cg could not be found! Aborting.."
+        exit
+    fi
+fi
+
+i=0
+passed=0
+failed=0
+
+# check if lexer exists
+if [[ -e $lexer ]] ; then
+    echo "$lexer is found. Starting tests.."
+else
+    echo "$lexer could not be found! Aborting.."
+    exit
+fi
+
+# Every io/<n>/ directory holding a pl0_code.txt is a test case.
+# pl0_code : Input to lexer, which is PL/0 source code.
+# lexer_out: Output of lexer. Expected to match io/<n>/lexer_out.txt.
+for case_dir in io/*/; do
+    pl0_code="${case_dir}pl0_code.txt"
+    gt_lexer_out="${case_dir}lexer_out.txt"
+
+    if [[ ! -e $pl0_code || ! -e $gt_lexer_out ]] ; then
+        continue
+    fi
+
+    echo -e "${GREEN_EMPH}TEST[$i]${DEEMPH}"
+
+    # create directories if needed
+    out_dir="io/your_outputs/$(basename "$case_dir")"
+    mkdir -p "$out_dir"
+    lexer_out="$out_dir/lexer_out.txt"
+
+    if [[ $binary_tokens = 1 ]] ; then
+        # run the lexer, then the code generator on both token lists
+        lexer_out="$out_dir/lexer_out.bin"
+        (timeout $timeout "$lexer" --binary-tokens "$pl0_code" "$lexer_out") > /dev/null 2> "$out_dir/lexer_err.txt"
+        status=$?
+
+        (timeout $timeout "$cg" --binary-tokens "$lexer_out" "$out_dir/cg_out_binary.txt") > /dev/null 2>&1
+        (timeout $timeout "$cg" "$gt_lexer_out" "$out_dir/cg_out_text.txt") > /dev/null 2>&1
+
+        _diff=$( { diff "$out_dir/cg_out_binary.txt" "$out_dir/cg_out_text.txt"; } 2>&1 )
+    else
+        # run the lexer
+        (timeout $timeout "$lexer" "$pl0_code" "$lexer_out") > /dev/null 2> "$out_dir/lexer_err.txt"
+        status=$?
+
+        # check if the correct lexer_out is produced
+        _diff=$( { diff -B -w $lexer_out $gt_lexer_out; } 2>&1 )
+    fi
+
+    if [[ $leak_check = 1 && $status != 0 ]] ; then
+        echo "TEST $i FAILED"
+        let failed=$failed+1
+
+        echo "The lexer exited with status $status in leak-check mode:"
+        echo "=================================================================="
+        cat "$out_dir/lexer_err.txt"
+        echo "=================================================================="
+        echo ""
+    elif [[ $_diff ]] ; then
+        echo "TEST $i FAILED"
+        let failed=$failed+1
+
+        echo "There is difference between $lexer_out and $gt_lexer_out:"
+        echo "=================================================================="
+        echo $_diff
+        echo "=================================================================="
+        echo -e "${EMPH}Test this yourself by running the following${DEEMPH}: "
+        echo "  (cd test/; ./$lexer $pl0_code $lexer_out)"
+        echo ""
+    else
+        echo "TEST $i PASSED"
+        let passed=$passed+1
+    fi
+    let i=$i+1
+done
+
+echo "# of tests       : $i"
+echo "# of tests passed: $passed"
+echo "# of tests failed: $failed"
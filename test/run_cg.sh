@@ -53,7 +53,7 @@ while read is_err cg_in cg_out others; do
     # if the error case is expected, then, do not run vm
     if [ "$is_err" = "not_error" ]; then
       # code should have been produced. therefore, run the vm.
-      (timeout $timeout "$vm" "$cg_out" "/dev/null" "$vm_inp" "$vm_out") > /dev/null 2>&1
+      (timeout $timeout "$vm" --fast "$cg_out" "/dev/null" "$vm_inp" "$vm_out") > /dev/null 2>&1
     fi
 
     
@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200809L
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * The tasks a worker has left: the indices next..end-1. The owner takes
+ * .. tasks from the front, thieves take them from the back.
+ * */
+typedef struct {
+    pthread_mutex_t lock;
+    int next, end;
+} TaskRange;
+
+typedef struct {
+    TaskRange* ranges;
+    int numberOfWorkers;
+    Task task;
+    void* context;
+} ThreadPool;
+
+typedef struct {
+    ThreadPool* pool;
+    int id;
+} Worker;
+
+/**
+ * Takes the next task of the given range. Returns its index, -1 if the range
+ * .. is empty.
+ * */
+static int takeTask(TaskRange* range)
+{
+    int index = -1;
+
+    pthread_mutex_lock(&range->lock);
+
+    if(range->next < range->end)
+        index = range->next++;
+
+    pthread_mutex_unlock(&range->lock);
+
+    return index;
+}
+
+/**
+ * Moves the upper half of the tasks left in some other worker's range into
+ * .. the range of the given worker, which is empty. Returns whether any task
+ * .. was stolen.
+ * */
+static int stealTasks(Worker* worker)
+{
+    ThreadPool* pool = worker->pool;
+
+    for(int k = 1; k < pool->numberOfWorkers; k++)
+    {
+        TaskRange* victim = &pool->ranges[(worker->id + k) % pool->numberOfWorkers];
+        int first = 0, end = 0;
+
+        pthread_mutex_lock(&victim->lock);
+
+        if(victim->next < victim->end)
+        {
+            end = victim->end;
+            first = victim->end - (victim->end - victim->next + 1) / 2;
+            victim->end = first;
+        }
+
+        pthread_mutex_unlock(&victim->lock);
+
+        if(first < end)
+        {
+            TaskRange* own = &pool->ranges[worker->id];
+
+            pthread_mutex_lock(&own->lock);
+            own->next = first;
+            own->end = end;
+            pthread_mutex_unlock(&own->lock);
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Runs tasks until there are none left to run or steal.
+ * */
+static void* runWorker(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    ThreadPool* pool = worker->pool;
+
+    do
+    {
+        int index;
+
+        while((index = takeTask(&pool->ranges[worker->id])) >= 0)
+            pool->task(pool->context, index);
+    }
+    while(stealTasks(worker));
+
+    return NULL;
+}
+
+int runTasks(int numberOfTasks, int numberOfThreads, Task task, void* context)
+{
+    if(numberOfThreads > numberOfTasks) numberOfThreads = numberOfTasks;
+    if(numberOfThreads < 1) numberOfThreads = 1;
+
+    ThreadPool pool = { NULL, numberOfThreads, task, context };
+
+    pool.ranges = (TaskRange*)malloc((size_t)numberOfThreads * sizeof(TaskRange));
+    Worker* workers = (Worker*)malloc((size_t)numberOfThreads * sizeof(Worker));
+    pthread_t* threads = (pthread_t*)malloc((size_t)numberOfThreads * sizeof(pthread_t));
+
+    int result = 0;
+
+    if(!pool.ranges || !workers || !threads)
+    {
+        // Run everything here instead
+        for(int i = 0; i < numberOfTasks; i++)
+            task(context, i);
+
+        result = -1;
+        goto cleanup;
+    }
+
+    // Split the tasks into contiguous ranges of nearly equal size
+    for(int w = 0; w < numberOfThreads; w++)
+    {
+        pthread_mutex_init(&pool.ranges[w].lock, NULL);
+        pool.ranges[w].next = (int)((long long)numberOfTasks * w / numberOfThreads);
+        pool.ranges[w].end = (int)((long long)numberOfTasks * (w + 1) / numberOfThreads);
+
+        workers[w].pool = &pool;
+        workers[w].id = w;
+    }
+
+    // The calling thread is worker 0. A worker whose thread cannot be started
+    // .. keeps its range, which the others steal: a worker only stops once it
+    // .. finds every range empty.
+    int started = 0;
+
+    for(int w = 1; w < numberOfThreads; w++)
+    {
+        if(pthread_create(&threads[w], NULL, runWorker, &workers[w]))
+            break;
+
+        started = w;
+    }
+
+    runWorker(&workers[0]);
+
+    for(int w = 1; w <= started; w++)
+        pthread_join(threads[w], NULL);
+
+    if(numberOfThreads > 1 && started == 0) result = -1;
+
+    for(int w = 0; w < numberOfThreads; w++)
+        pthread_mutex_destroy(&pool.ranges[w].lock);
+
+cleanup:
+    free(pool.ranges);
+    free(workers);
+    free(threads);
+
+    return result;
+}
+
+int getNumberOfProcessors()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n > 0 ? (int)n : 1;
+}
@@ -0,0 +1,28 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+/**
+ * A task run by runTasks(): called with the context given to runTasks() and
+ * .. the index of the task.
+ * */
+typedef void (*Task)(void* context, int index);
+
+/**
+ * Runs task(context, i) for every i in 0..numberOfTasks-1 on a pool of
+ * .. numberOfThreads threads, and returns once all of them are done.
+ * Work stealing: every thread starts with its own contiguous range of the
+ * .. indices and runs them in order. A thread that runs out steals the upper
+ * .. half of the range another thread has left, so long tasks do not hold
+ * .. back the rest of the batch.
+ * Tasks run concurrently, so they may only share read-only state.
+ * Returns 0 on success. If no thread could be started, every task is run on
+ * .. the calling thread and -1 is returned.
+ * */
+int runTasks(int numberOfTasks, int numberOfThreads, Task task, void* context);
+
+/**
+ * Returns the number of processors online, at least 1.
+ * */
+int getNumberOfProcessors();
+
+#endif
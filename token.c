@@ -6,29 +6,74 @@ void initTokenList(TokenList* tokenList)
 {
     tokenList->tokens = NULL;
     tokenList->numberOfTokens = 0;
+    tokenList->capacity = 0;
 }
 
 void addToken(TokenList* tokenList, Token token)
 {
-    // Increase number of tokens
-    tokenList->numberOfTokens++;
-
-    // Allocate space for new token
-    tokenList->tokens = (Token*)realloc(tokenList->tokens, (tokenList->numberOfTokens) * sizeof(Token));
+    // Grow the allocated space geometrically if it is full
+    if(tokenList->numberOfTokens == tokenList->capacity)
+    {
+        // The capacity is at least doubled
+        const int initialCapacity = 64;
+        int newCapacity = tokenList->capacity ? 2 * tokenList->capacity : initialCapacity;
+
+        if(reserveTokenList(tokenList, newCapacity))
+        {
+            fprintf(stderr, "Could not allocate space for %d tokens.\n", newCapacity);
+            return;
+        }
+    }
 
     // Add token to the end of the list
-    tokenList->tokens[tokenList->numberOfTokens - 1] = token;
+    tokenList->tokens[tokenList->numberOfTokens++] = token;
+}
+
+int reserveTokenList(TokenList* tokenList, int capacity)
+{
+    if(!tokenList) return -1;
+
+    if(capacity <= tokenList->capacity) return 0;
+
+    Token* tokens = (Token*)realloc(tokenList->tokens, capacity * sizeof(Token));
+    if(!tokens) return -1;
+
+    tokenList->tokens = tokens;
+    tokenList->capacity = capacity;
+
+    return 0;
+}
+
+void shrinkTokenList(TokenList* tokenList)
+{
+    if(!tokenList || tokenList->numberOfTokens == tokenList->capacity) return;
+
+    if(tokenList->numberOfTokens == 0)
+    {
+        free(tokenList->tokens);
+        tokenList->tokens = NULL;
+        tokenList->capacity = 0;
+        return;
+    }
+
+    Token* tokens = (Token*)realloc(tokenList->tokens, tokenList->numberOfTokens * sizeof(Token));
+
+    // Keeping the larger allocation is harmless if shrinking fails
+    if(!tokens) return;
+
+    tokenList->tokens = tokens;
+    tokenList->capacity = tokenList->numberOfTokens;
 }
 
 TokenList getCopy(TokenList src)
 {
     TokenList copy;
-    
-    copy.numberOfTokens = src.numberOfTokens;
 
-    if(src.tokens)
+    initTokenList(&copy);
+
+    if(src.tokens && reserveTokenList(&copy, src.numberOfTokens) == 0)
     {
-        copy.tokens = (Token*)malloc(src.numberOfTokens * sizeof(Token));
+        copy.numberOfTokens = src.numberOfTokens;
 
         for(int i = 0; i < src.numberOfTokens; i++)
             copy.tokens[i] = src.tokens[i];
@@ -54,8 +99,7 @@ TokenList readTokenList(FILE* in)
 {
     TokenList tokenList;
 
-    tokenList.tokens = NULL;
-    tokenList.numberOfTokens = 0;
+    initTokenList(&tokenList);
 
     if(!in) return tokenList;
 
@@ -64,11 +108,14 @@ TokenList readTokenList(FILE* in)
 
     Token token;
 
-    while( fscanf(in, "%10d   %12s\n", &token.id, token.lexeme) == 2 )
+    // The width keeps the lexeme within MAX_LEXEME_LENGTH characters
+    while( fscanf(in, "%10d   %11s\n", &token.id, token.lexeme) == 2 )
     {
         addToken(&tokenList, token);
     }
 
+    shrinkTokenList(&tokenList);
+
     return tokenList;
 }
 
@@ -80,6 +127,8 @@ void deleteTokenList(TokenList* tokenList)
         free(tokenList->tokens);
 
     tokenList->tokens = NULL;
+    tokenList->numberOfTokens = 0;
+    tokenList->capacity = 0;
 }
 
 
@@ -15,11 +15,14 @@ typedef struct {
 
 /**
  * The struct to store list of tokens and keep track
- * of number of tokens included in the list
+ * of number of tokens included in the list.
+ * capacity is the number of tokens the allocated space can hold, which is
+ * .. grown geometrically so that adding a token is O(1) amortized.
  * */
 typedef struct {
     Token* tokens;
     int numberOfTokens;
+    int capacity;
 } TokenList;
 
 /**
@@ -40,6 +43,20 @@ void initTokenList(TokenList*);
  * */
 void addToken(TokenList*, Token);
 
+/**
+ * Makes sure that the given TokenList can hold at least the given number of
+ * .. tokens without reallocating. Useful when the number of tokens to be added
+ * .. can be estimated beforehand.
+ * Returns 0 on success, -1 if the allocation fails.
+ * */
+int reserveTokenList(TokenList*, int capacity);
+
+/**
+ * Releases the unused capacity of the given TokenList, so that the allocated
+ * .. space holds exactly numberOfTokens tokens.
+ * */
+void shrinkTokenList(TokenList*);
+
 /**
  * Creates and returns a copy of the given TokenList.
  * TokenList dynamically allocates memory for its list.
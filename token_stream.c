@@ -0,0 +1,231 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "token_stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Hashes the null-terminated lexeme (FNV-1a).
+ * */
+static uint32_t hashLexeme(const char* lexeme)
+{
+    uint32_t hash = 2166136261u;
+
+    for(; *lexeme; lexeme++)
+        hash = (hash ^ (unsigned char)*lexeme) * 16777619u;
+
+    return hash;
+}
+
+int writeTokenStream(TokenList tokenList, FILE* out)
+{
+    if(!out || tokenList.numberOfTokens < 0 || (tokenList.numberOfTokens > 0 && !tokenList.tokens))
+        return -1;
+
+    uint32_t numberOfTokens = (uint32_t)tokenList.numberOfTokens;
+
+    // Open addressing table of interned lexemes, at most half full. Each slot
+    // .. holds the index of the lexeme plus one, or 0 if the slot is empty.
+    size_t slotCount = 16;
+    while(slotCount < 2 * (size_t)numberOfTokens) slotCount *= 2;
+
+    uint32_t* slots = (uint32_t*)calloc(slotCount, sizeof(uint32_t));
+    uint32_t* lexemeIndices = (uint32_t*)malloc((numberOfTokens + 1) * sizeof(uint32_t));
+    uint32_t* lexemeOffsets = (uint32_t*)malloc((numberOfTokens + 1) * sizeof(uint32_t));
+    uint8_t* ids = (uint8_t*)malloc(numberOfTokens + 1);
+    char* lexemeTable = (char*)malloc((size_t)numberOfTokens * (MAX_LEXEME_LENGTH + 1) + 1);
+
+    int err = -1;
+    uint32_t numberOfLexemes = 0;
+    uint32_t lexemeTableSize = 0;
+
+    if(!slots || !lexemeIndices || !lexemeOffsets || !ids || !lexemeTable)
+        goto cleanup;
+
+    for(uint32_t i = 0; i < numberOfTokens; i++)
+    {
+        const Token* token = &tokenList.tokens[i];
+        size_t lexemeLength = strnlen(token->lexeme, MAX_LEXEME_LENGTH + 1);
+
+        if(token->id < 0 || token->id > UINT8_MAX || lexemeLength > MAX_LEXEME_LENGTH)
+            goto cleanup;
+
+        ids[i] = (uint8_t)token->id;
+
+        // Find the lexeme, or intern it if this is its first occurrence
+        size_t slot = hashLexeme(token->lexeme) & (slotCount - 1);
+
+        while(slots[slot] && strcmp(lexemeTable + lexemeOffsets[slots[slot] - 1], token->lexeme))
+            slot = (slot + 1) & (slotCount - 1);
+
+        if(!slots[slot])
+        {
+            lexemeOffsets[numberOfLexemes] = lexemeTableSize;
+            memcpy(lexemeTable + lexemeTableSize, token->lexeme, lexemeLength + 1);
+            lexemeTableSize += (uint32_t)lexemeLength + 1;
+
+            slots[slot] = ++numberOfLexemes;
+        }
+
+        lexemeIndices[i] = slots[slot] - 1;
+    }
+
+    TokenStreamHeader header;
+    memcpy(header.magic, TOKEN_STREAM_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_STREAM_VERSION;
+    header.reserved = 0;
+    header.numberOfTokens = numberOfTokens;
+    header.numberOfLexemes = numberOfLexemes;
+    header.lexemeTableSize = lexemeTableSize;
+
+    if( fwrite(&header, sizeof(header), 1, out) == 1 &&
+        fwrite(lexemeIndices, sizeof(uint32_t), numberOfTokens, out) == numberOfTokens &&
+        fwrite(lexemeOffsets, sizeof(uint32_t), numberOfLexemes, out) == numberOfLexemes &&
+        fwrite(ids, 1, numberOfTokens, out) == numberOfTokens &&
+        fwrite(lexemeTable, 1, lexemeTableSize, out) == lexemeTableSize )
+    {
+        err = 0;
+    }
+
+cleanup:
+    free(slots);
+    free(lexemeIndices);
+    free(lexemeOffsets);
+    free(ids);
+    free(lexemeTable);
+
+    return err;
+}
+
+int openTokenStream(FILE* in, TokenStream* tokenStream)
+{
+    TokenStreamHeader header;
+
+    if(!tokenStream) return -1;
+
+    memset(tokenStream, 0, sizeof(*tokenStream));
+
+    // Regular files are mapped, so the arrays below alias the file contents
+    SourceCode file = readSourceCode(in);
+
+    if(!file.text || file.length < sizeof(header))
+        goto invalid;
+
+    memcpy(&header, file.text, sizeof(header));
+
+    if(memcmp(header.magic, TOKEN_STREAM_MAGIC, sizeof(header.magic)) || header.version != TOKEN_STREAM_VERSION)
+        goto invalid;
+
+    // The sections are accessed in place, which requires 4 byte alignment.
+    // Mappings and heap allocations both start aligned.
+    if((uintptr_t)file.text % sizeof(uint32_t))
+        goto invalid;
+
+    uint64_t expectedLength = (uint64_t)sizeof(header)
+        + (uint64_t)header.numberOfTokens * (sizeof(uint32_t) + 1)
+        + (uint64_t)header.numberOfLexemes * sizeof(uint32_t)
+        + header.lexemeTableSize;
+
+    if(expectedLength != file.length || header.numberOfTokens > INT32_MAX)
+        goto invalid;
+
+    const char* section = file.text + sizeof(header);
+
+    tokenStream->lexemeIndices = (const uint32_t*)section;
+    section += (size_t)header.numberOfTokens * sizeof(uint32_t);
+
+    tokenStream->lexemeOffsets = (const uint32_t*)section;
+    section += (size_t)header.numberOfLexemes * sizeof(uint32_t);
+
+    tokenStream->ids = (const uint8_t*)section;
+    section += header.numberOfTokens;
+
+    tokenStream->lexemeTable = section;
+
+    // Every lexeme must start within the table and be null-terminated after
+    // .. at most MAX_LEXEME_LENGTH characters
+    for(uint32_t i = 0; i < header.numberOfLexemes; i++)
+    {
+        uint32_t offset = tokenStream->lexemeOffsets[i];
+
+        if( offset >= header.lexemeTableSize ||
+            !memchr(tokenStream->lexemeTable + offset, '\0', header.lexemeTableSize - offset) ||
+            strlen(tokenStream->lexemeTable + offset) > MAX_LEXEME_LENGTH )
+        {
+            goto invalid;
+        }
+    }
+
+    for(uint32_t i = 0; i < header.numberOfTokens; i++)
+    {
+        if(tokenStream->lexemeIndices[i] >= header.numberOfLexemes)
+            goto invalid;
+    }
+
+    tokenStream->numberOfTokens = (int)header.numberOfTokens;
+    tokenStream->file = file;
+
+    return 0;
+
+invalid:
+    deleteSourceCode(&file);
+    memset(tokenStream, 0, sizeof(*tokenStream));
+
+    return -1;
+}
+
+const char* getTokenStreamLexeme(const TokenStream* tokenStream, int tokenInd)
+{
+    return tokenStream->lexemeTable + tokenStream->lexemeOffsets[tokenStream->lexemeIndices[tokenInd]];
+}
+
+TokenList getTokenListFromStream(const TokenStream* tokenStream)
+{
+    TokenList tokenList;
+
+    initTokenList(&tokenList);
+
+    if(!tokenStream || tokenStream->numberOfTokens == 0)
+        return tokenList;
+
+    if(reserveTokenList(&tokenList, tokenStream->numberOfTokens))
+        return tokenList;
+
+    for(int i = 0; i < tokenStream->numberOfTokens; i++)
+    {
+        Token* token = &tokenList.tokens[i];
+
+        token->id = tokenStream->ids[i];
+        strcpy(token->lexeme, getTokenStreamLexeme(tokenStream, i));
+    }
+
+    tokenList.numberOfTokens = tokenStream->numberOfTokens;
+
+    return tokenList;
+}
+
+void closeTokenStream(TokenStream* tokenStream)
+{
+    if(!tokenStream) return;
+
+    deleteSourceCode(&tokenStream->file);
+    memset(tokenStream, 0, sizeof(*tokenStream));
+}
+
+TokenList readTokenStream(FILE* in)
+{
+    TokenStream tokenStream;
+    TokenList tokenList;
+
+    if(openTokenStream(in, &tokenStream))
+    {
+        initTokenList(&tokenList);
+        return tokenList;
+    }
+
+    tokenList = getTokenListFromStream(&tokenStream);
+
+    closeTokenStream(&tokenStream);
+
+    return tokenList;
+}
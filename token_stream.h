@@ -0,0 +1,88 @@
+#ifndef __TOKEN_STREAM_H__
+#define __TOKEN_STREAM_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "token.h"
+#include "source_code.h"
+
+/**
+ * Binary token stream: a compact alternative to the text token table written
+ * .. by printTokenList(). The file consists of, in order:
+ *   - TokenStreamHeader
+ *   - uint32_t lexemeIndices[numberOfTokens]: the lexeme of each token, as an
+ *     .. index into lexemeOffsets
+ *   - uint32_t lexemeOffsets[numberOfLexemes]: the start of each lexeme in
+ *     .. the lexeme table
+ *   - uint8_t ids[numberOfTokens]: the id of each token
+ *   - char lexemeTable[lexemeTableSize]: null-terminated lexemes
+ * Each distinct lexeme is stored once, so reserved words and special symbols
+ * .. cost 5 bytes per token regardless of their spelling.
+ * Integers are stored in the byte order of the machine that wrote the file.
+ * */
+
+#define TOKEN_STREAM_MAGIC "PL0T"
+#define TOKEN_STREAM_VERSION 1
+
+typedef struct {
+    char magic[4];            // TOKEN_STREAM_MAGIC, not null-terminated
+    uint16_t version;         // TOKEN_STREAM_VERSION
+    uint16_t reserved;        // 0
+    uint32_t numberOfTokens;
+    uint32_t numberOfLexemes;
+    uint32_t lexemeTableSize; // in bytes
+} TokenStreamHeader;
+
+/**
+ * A read-only view of a binary token stream. The arrays point directly into
+ * .. the file contents, which are memory mapped for regular files; nothing
+ * .. is copied or parsed when the stream is opened.
+ * */
+typedef struct {
+    int numberOfTokens;
+    const uint8_t* ids;
+    const uint32_t* lexemeIndices;
+    const uint32_t* lexemeOffsets;
+    const char* lexemeTable;
+    SourceCode file; // the storage of the file contents
+} TokenStream;
+
+/**
+ * Writes the given TokenList to the given FILE as a binary token stream.
+ * Returns 0 on success, -1 if the list could not be written.
+ * */
+int writeTokenStream(TokenList, FILE*);
+
+/**
+ * Opens the binary token stream in the given FILE, from its current position
+ * .. until EOF, and validates it. All the lexemes of a validated stream are
+ * .. null-terminated and at most MAX_LEXEME_LENGTH characters long.
+ * Returns 0 on success. Returns -1 if the file is not a valid token stream,
+ * .. in which case the stream is left empty.
+ * */
+int openTokenStream(FILE*, TokenStream*);
+
+/**
+ * Returns the lexeme of the token at the given index of the stream.
+ * */
+const char* getTokenStreamLexeme(const TokenStream*, int tokenInd);
+
+/**
+ * Creates a TokenList holding the tokens of the given stream. The list is
+ * .. allocated once, with the exact number of tokens.
+ * */
+TokenList getTokenListFromStream(const TokenStream*);
+
+/**
+ * Releases the storage of the stream and resets it to empty.
+ * */
+void closeTokenStream(TokenStream*);
+
+/**
+ * Reads a list of tokens from the binary token stream in the given file.
+ * The counterpart of readTokenList() for the binary format. If the file is
+ * .. not a valid token stream, returns an empty list.
+ * */
+TokenList readTokenStream(FILE*);
+
+#endif
@@ -1,17 +1,15 @@
-#ifndef __DATA_H__
-#define __DATA_H__
+#ifndef __VM_DATA_H__
+#define __VM_DATA_H__
+
+// The instructions and opcodes are shared with the code generator, so the
+// .. code it generates can be run without being written out
+#include "../data.h"
 
 #define MAX_STACK_HEIGHT 2000
-#define MAX_CODE_LENGTH  500
 #define MAX_LEXI_LEVELS  3
-#define REGISTER_FILE_REG_COUNT 16
 
-typedef struct {
-    int op;  // opcode
-    int r;   // reg
-    int l;   // L
-    int m;   // M
-} Instruction;
+// The number of opcodes, including the illegal opcode 0
+#define NUMBER_OF_OPCODES (GEQ + 1)
 
 /**
  * Virtual machine state holder
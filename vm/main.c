@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "vm.h"
 
@@ -6,6 +7,57 @@ int main(int argc, char **argv)
 {
     FILE *inp, *outp, *vm_inp, *vm_outp;
 
+    VMOptions options = getDefaultVMOptions();
+
+    // 0 on success, -1 if the program faulted
+    int result = 0;
+
+    // Options come before the file paths
+    while(argc > 3)
+    {
+        if(!strcmp(argv[1], "--fast"))
+        {
+            options.trace = VM_TRACE_OFF;
+        }
+        else if(!strcmp(argv[1], "--no-fusion"))
+        {
+            options.fuseInstructions = 0;
+        }
+        else if(!strcmp(argv[1], "--trace-every") && argc > 4 && atoi(argv[2]) > 0)
+        {
+            options.trace = VM_TRACE_SAMPLED;
+            options.traceLength = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--trace-last") && argc > 4 && atoi(argv[2]) > 0)
+        {
+            options.trace = VM_TRACE_LAST;
+            options.traceLength = atoi(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--max-steps") && argc > 4 && atoll(argv[2]) > 0)
+        {
+            options.maxSteps = atoll(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if(!strcmp(argv[1], "--time-limit") && argc > 4 && atof(argv[2]) > 0)
+        {
+            options.timeLimit = atof(argv[2]);
+            argc--;
+            argv++;
+        }
+        else
+        {
+            break;
+        }
+
+        argc--;
+        argv++;
+    }
+
     if(argc == 3)
     {
         inp     = fopen(argv[1], "r");
@@ -14,7 +66,7 @@ int main(int argc, char **argv)
         vm_inp  = stdin;
         vm_outp = stdout;
 
-        simulateVM(inp, outp, vm_inp, vm_outp);
+        result = runVMWithOptions(inp, outp, vm_inp, vm_outp, options);
 
         fclose(inp);
         fclose(outp);
@@ -32,7 +84,7 @@ int main(int argc, char **argv)
         if( strcmp(argv[3], "-") ) vm_outp = fopen(argv[4], "w");
         else                       vm_outp = stdout;
 
-        simulateVM(inp, outp, vm_inp, vm_outp);
+        result = runVMWithOptions(inp, outp, vm_inp, vm_outp, options);
 
         fclose(inp);
         fclose(outp);
@@ -45,7 +97,25 @@ int main(int argc, char **argv)
     }
     else
     {
-        fprintf(stderr, "Usage: vm.out (ins_inp_file) (simul_outp_file) [vm_inp_file=stdin] [vm_outp_file=stdout]\n");
+        fprintf(stderr, "Usage: vm.out [--fast [--no-fusion] | --trace-every n | --trace-last k] [--max-steps n] [--time-limit s] (ins_inp_file) (simul_outp_file) [vm_inp_file=stdin] [vm_outp_file=stdout]\n");
+
+        fprintf(stderr, "\n\t--fast  Run without writing the execution history. The simulation output"
+                        "\n\t        file is left empty.\n");
+
+        fprintf(stderr, "\n\t--no-fusion  With --fast, execute common instruction sequences one"
+                        "\n\t             instruction at a time instead of as superinstructions.\n");
+
+        fprintf(stderr, "\n\t--trace-every  Write only every n-th executed instruction to the"
+                        "\n\t               execution history.\n");
+
+        fprintf(stderr, "\n\t--trace-last  Write only the last k executed instructions to the execution"
+                        "\n\t              history, once the program halts or faults.\n");
+
+        fprintf(stderr, "\n\t--max-steps  Stop the program as a fault once it executes more than n"
+                        "\n\t             instructions.\n");
+
+        fprintf(stderr, "\n\t--time-limit  Stop the program as a fault once it runs for more than s"
+                        "\n\t              seconds.\n");
 
         fprintf(stderr, "\n\tins_inp_file  The path to the file containing the list of instructions to"
                         "\n\t              be loaded to code memory of the virtual machine.\n");
@@ -60,5 +130,5 @@ int main(int argc, char **argv)
                         "\n\t             by SIO instructions. Use dash ('-') to assign to stdout.\n");
     }
 
-    return 0;
+    return result;
 }
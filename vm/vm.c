@@ -0,0 +1,1228 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+#include "data.h"
+#include "vm.h"
+
+/**
+ * Direct threading: each loaded instruction carries the address of the code
+ * .. executing its opcode, so dispatching is a single indirect jump. Relies
+ * .. on the labels-as-values extension of GCC and Clang; other compilers fall
+ * .. back to dispatching through a switch.
+ * */
+#if defined(__GNUC__) && !defined(VM_NO_COMPUTED_GOTO)
+#define VM_DIRECT_THREADED 1
+#else
+#define VM_DIRECT_THREADED 0
+#endif
+
+/**
+ * The layout of the instructions executeProgram() loads: packed into 8 bytes,
+ * .. so that dispatching reads a single word and a program takes a third of
+ * .. the cache it takes unpacked. The unpacked layout, four ints and the
+ * .. address of the handler of the instruction, is kept to be benchmarked
+ * .. against (see vm_bench.c), and is selected by VM_UNPACKED_INSTRUCTIONS.
+ * */
+#if defined(VM_UNPACKED_INSTRUCTIONS)
+#define VM_PACKED_INSTRUCTIONS 0
+#else
+#define VM_PACKED_INSTRUCTIONS 1
+#endif
+
+/**
+ * The largest L field of LOD, STO and CAL, which is packed into 16 bits. The
+ * .. static chain is walked a link per level, and no program nests anywhere
+ * .. near this deep; larger L fields are invalid.
+ * */
+#define VM_MAX_LEVEL_DIFFERENCE UINT16_MAX
+
+/**
+ * The string representation of each opcode, as printed in the simulation output
+ * */
+const char* opcodes[] = {
+    "illegal", // opcode 0 is illegal
+    "lit", "rtn", "lod", "sto", "cal", // 1, 2, 3 ..
+    "inc", "jmp", "jpc", "sio", "sio",
+    "sio", "neg", "add", "sub", "mul",
+    "div", "odd", "mod", "eql", "neq",
+    "lss", "leq", "gtr", "geq"
+};
+
+/**
+ * Returns the string representation of the given opcode, which is "illegal"
+ * .. for the opcodes outside of the table.
+ * */
+static const char* getOpcodeName(int op)
+{
+    return (op > 0 && op < NUMBER_OF_OPCODES) ? opcodes[op] : opcodes[0];
+}
+
+/**
+ * The size of the display of executeProgram(): the deepest static nesting of
+ * .. activation records it resolves in constant time
+ * */
+#define VM_DISPLAY_SIZE 64
+
+/**
+ * The number of calls executeProgram() can track in its display. Every call
+ * .. takes at least 4 stack slots unless records overlap.
+ * */
+#define VM_MAX_CALL_DEPTH (MAX_STACK_HEIGHT / 4)
+
+/**
+ * Opcodes of the loaded instructions, following the PM/0 opcodes
+ * */
+enum {
+    INVALID = NUMBER_OF_OPCODES, // an instruction failing isInstructionValid()
+    END_OF_CODE,                 // the instruction after the last one
+
+    // Superinstructions, each executing the sequence its name spells
+    LOD_WRITE,
+    LOD_LIT_ADD_STO, LOD_LIT_SUB_STO,
+    EQL_JPC, NEQ_JPC, LSS_JPC, LEQ_JPC, GTR_JPC, GEQ_JPC,
+
+    NUMBER_OF_HANDLERS
+};
+
+/**
+ * A loaded instruction, prepared for execution by executeProgram(). Jump
+ * .. targets are validated when the instruction is loaded, so m is used as
+ * .. the index of the next instruction as is. Packed, op selects the handler
+ * .. from the handler table, and r and l, which are registers or an L field
+ * .. of at most VM_MAX_LEVEL_DIFFERENCE wherever they are used, are narrowed.
+ * */
+#if VM_PACKED_INSTRUCTIONS
+typedef struct {
+    uint8_t op;
+    uint8_t r;
+    uint16_t l;
+    int32_t m;
+} ThreadedInstruction;
+#else
+typedef struct {
+#if VM_DIRECT_THREADED
+    const void* handler; // the code executing the instruction
+#endif
+    int op, r, l, m;
+} ThreadedInstruction;
+#endif
+
+/**
+ * Returns whether the loaded instructions starting at the given one have the
+ * .. given opcodes. The opcode list is terminated by 0.
+ * */
+static int matchesSequence(const ThreadedInstruction* ins, const int* ops)
+{
+    for(; *ops; ins++, ops++)
+    {
+        if(ins->op != *ops) return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Rewrites the common sequences of the given loaded program into
+ * .. superinstructions. Only the opcode of the first instruction of a sequence
+ * .. is replaced: its operands, and the remaining instructions of the sequence,
+ * .. are left in place. A superinstruction reads the operands of the rest of
+ * .. the sequence from the following slots and then skips them, so jumping into
+ * .. the middle of a sequence still executes the original instructions, and no
+ * .. jump target has to be relocated.
+ * The program must end with END_OF_CODE, which never matches a sequence.
+ * */
+static void fuseInstructions(ThreadedInstruction* program, int numOfIns)
+{
+    static const struct {
+        int ops[5]; // terminated by 0
+        int fused;
+    } sequences[] = {
+        { { LOD, SIO_WRITE, 0 },     LOD_WRITE },
+        { { LOD, LIT, ADD, STO, 0 }, LOD_LIT_ADD_STO },
+        { { LOD, LIT, SUB, STO, 0 }, LOD_LIT_SUB_STO },
+        { { EQL, JPC, 0 },           EQL_JPC },
+        { { NEQ, JPC, 0 },           NEQ_JPC },
+        { { LSS, JPC, 0 },           LSS_JPC },
+        { { LEQ, JPC, 0 },           LEQ_JPC },
+        { { GTR, JPC, 0 },           GTR_JPC },
+        { { GEQ, JPC, 0 },           GEQ_JPC }
+    };
+
+    for(int i = 0; i < numOfIns; i++)
+    {
+        for(size_t j = 0; j < sizeof(sequences) / sizeof(sequences[0]); j++)
+        {
+            if(matchesSequence(&program[i], sequences[j].ops))
+            {
+                program[i].op = sequences[j].fused;
+                break;
+            }
+        }
+    }
+}
+
+void initVM(VirtualMachine* vm)
+{
+    if(!vm) return;
+
+    vm->BP = 1;
+    vm->SP = vm->PC = vm->IR = 0;
+
+    for(int i = 0; i < REGISTER_FILE_REG_COUNT; i++)
+        vm->RF[i] = 0;
+
+    for(int i = 0; i < MAX_STACK_HEIGHT; i++)
+        vm->stack[i] = 0;
+}
+
+/**
+ * Reads the instructions from the given file until EOF into a new allocation,
+ * .. which is grown geometrically, so programs of any length can be loaded.
+ * Sets numOfIns to the number of instructions read. Returns NULL if the
+ * .. allocation fails.
+ * */
+Instruction* readInstructions(FILE* in, int* numOfIns)
+{
+    int capacity = 512;
+    Instruction* ins = (Instruction*)malloc(capacity * sizeof(Instruction));
+    Instruction current;
+
+    *numOfIns = 0;
+
+    if(!ins) return NULL;
+
+    while(fscanf(in, "%d %d %d %d", &current.op, &current.r, &current.l, &current.m) == 4)
+    {
+        if(*numOfIns == capacity)
+        {
+            Instruction* grown = (Instruction*)realloc(ins, 2 * capacity * sizeof(Instruction));
+
+            if(!grown)
+            {
+                free(ins);
+                return NULL;
+            }
+
+            ins = grown;
+            capacity *= 2;
+        }
+
+        ins[(*numOfIns)++] = current;
+    }
+
+    return ins;
+}
+
+void dumpInstructions(FILE* out, const Instruction* ins, int numOfIns)
+{
+    fprintf(out, "***Code Memory***\n%3s %3s %3s %3s %3s \n", "#", "OP", "R", "L", "M");
+
+    for(int i = 0; i < numOfIns; i++)
+    {
+        fprintf(out, "%3d %3s %3d %3d %3d \n", i, getOpcodeName(ins[i].op), ins[i].r, ins[i].l, ins[i].m);
+    }
+}
+
+/**
+ * Prints the stack from the bottom up to SP, separating the activation
+ * .. records with '|'. The records below the current one are found through
+ * .. the dynamic links, which are only followed downwards so that corrupted
+ * .. links cannot loop.
+ * */
+void dumpStack(FILE* out, int* stack, int SP, int BP)
+{
+    if(BP <= 0 || BP + 2 >= MAX_STACK_HEIGHT) return;
+
+    // The bottom of the stack
+    if(BP == 1) fprintf(out, "%3d ", 0);
+
+    // Print the activation records below the current one
+    if(BP != 1 && stack[BP + 2] < BP) dumpStack(out, stack, BP - 1, stack[BP + 2]);
+
+    // Print the current activation record
+    if(BP <= SP)
+    {
+        fprintf(out, "| ");
+
+        for(int i = BP; i <= SP; i++)
+            fprintf(out, "%3d ", stack[i]);
+    }
+}
+
+/**
+ * Reports a fault of the program being executed on options.faultOutp, or on
+ * .. stderr if it is NULL, naming the procedure of the faulting instruction
+ * .. if the program has symbols.
+ * */
+static void reportFault(const VMOptions* options, const char* fault, int PC)
+{
+    FILE* out = options->faultOutp ? options->faultOutp : stderr;
+    const char* procedure = findCodeObjectSymbol(options->symbols, PC);
+
+    if(procedure && *procedure)
+        fprintf(out, "VM fault at instruction %d in procedure %s: %s\n", PC, procedure, fault);
+    else
+        fprintf(out, "VM fault at instruction %d: %s\n", PC, fault);
+
+    fprintf(out, "Terminating VM..\n");
+}
+
+/**
+ * The number of instructions executed between two readings of the clock,
+ * .. when the run has a time limit. Traced instructions are much slower, so
+ * .. the clock is read more often.
+ * */
+#define VM_CLOCK_CHECK_INTERVAL (1 << 20)
+#define VM_TRACED_CLOCK_CHECK_INTERVAL (1 << 10)
+
+/**
+ * The budget of a run, as given by VMOptions. checkBudget() has to be called
+ * .. once the number of executed instructions reaches checkpoint.
+ * */
+typedef struct {
+    long long maxSteps;
+    double timeLimit;
+    struct timespec start;
+    int clockCheckInterval;
+    long long checkpoint;
+} Budget;
+
+/**
+ * Returns the number of seconds elapsed since the given time.
+ * */
+static double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)(now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Sets the checkpoint of the budget for the given number of executed
+ * .. instructions: the next clock reading, or the first instruction over
+ * .. maxSteps, whichever comes first.
+ * */
+static void setCheckpoint(Budget* budget, long long steps)
+{
+    budget->checkpoint = LLONG_MAX;
+
+    if(budget->timeLimit > 0)
+        budget->checkpoint = steps + budget->clockCheckInterval;
+
+    if(budget->maxSteps > 0 && budget->maxSteps < budget->checkpoint)
+        budget->checkpoint = budget->maxSteps + 1;
+}
+
+static void initBudget(Budget* budget, VMOptions options, int clockCheckInterval)
+{
+    budget->maxSteps = options.maxSteps;
+    budget->timeLimit = options.timeLimit;
+    budget->clockCheckInterval = clockCheckInterval;
+
+    if(budget->timeLimit > 0)
+        clock_gettime(CLOCK_MONOTONIC, &budget->start);
+
+    setCheckpoint(budget, 0);
+}
+
+/**
+ * Returns the fault of a run that has executed the given number of
+ * .. instructions if it is over its budget, NULL otherwise, in which case the
+ * .. checkpoint is moved forward.
+ * */
+static const char* checkBudget(Budget* budget, long long steps)
+{
+    if(budget->maxSteps > 0 && steps > budget->maxSteps)
+        return "instruction budget exceeded";
+
+    if(budget->timeLimit > 0 && secondsSince(&budget->start) > budget->timeLimit)
+        return "time limit exceeded";
+
+    setCheckpoint(budget, steps);
+
+    return NULL;
+}
+
+/**
+ * Returns whether the fields of the instruction are valid for its opcode:
+ * .. registers are within the register file and jump targets are within the
+ * .. code. The target numOfIns is valid; it is reported as a fault only if
+ * .. it is jumped to.
+ * */
+static int isInstructionValid(Instruction ins, int numOfIns)
+{
+    #define IS_REG(x) ((x) >= 0 && (x) < REGISTER_FILE_REG_COUNT)
+
+    switch(ins.op)
+    {
+        case LIT: case SIO_WRITE: case SIO_READ: case ODD:
+            return IS_REG(ins.r);
+        case LOD: case STO:
+            return IS_REG(ins.r) && ins.l >= 0 && ins.l <= VM_MAX_LEVEL_DIFFERENCE;
+        case CAL:
+            return ins.l >= 0 && ins.l <= VM_MAX_LEVEL_DIFFERENCE && ins.m >= 0 && ins.m <= numOfIns;
+        case JMP:
+            return ins.m >= 0 && ins.m <= numOfIns;
+        case JPC:
+            return IS_REG(ins.r) && ins.m >= 0 && ins.m <= numOfIns;
+        case RTN: case INC: case SIO_HALT:
+            return 1;
+        case NEG:
+            return IS_REG(ins.r) && IS_REG(ins.l);
+        case ADD: case SUB: case MUL: case DIV: case MOD:
+        case EQL: case NEQ: case LSS: case LEQ: case GTR: case GEQ:
+            return IS_REG(ins.r) && IS_REG(ins.l) && IS_REG(ins.m);
+        default:
+            return 0;
+    }
+
+    #undef IS_REG
+}
+
+/**
+ * Returns whether the stack index is within the stack.
+ * */
+static int isStackIndex(int index)
+{
+    return index >= 0 && index < MAX_STACK_HEIGHT;
+}
+
+/**
+ * Sets base to the base pointer of the activation record L levels down the
+ * .. static links, starting from the activation record at BP.
+ * Returns 0 on success, -1 if a static link is outside the stack.
+ * */
+static int findBasePointer(int* stack, int BP, int L, int* base)
+{
+    *base = BP;
+
+    for(int i = 0; i < L; i++)
+    {
+        if(!isStackIndex(*base + 1)) return -1;
+
+        *base = stack[*base + 1];
+    }
+
+    return 0;
+}
+
+/**
+ * Executes the given instruction of a program of numOfIns instructions on
+ * .. the given virtual machine.
+ * Returns 1 if the instruction halts the machine, 0 if the machine continues
+ * .. and -1 if the instruction faults, in which case the fault is reported
+ * .. as the options select, and the machine is left unchanged.
+ * */
+int executeInstruction(VirtualMachine* vm, Instruction ins, int numOfIns, FILE* vmIn, FILE* vmOut, const VMOptions* options)
+{
+    int base;
+
+    if(ins.op > 0 && ins.op < NUMBER_OF_OPCODES && !isInstructionValid(ins, numOfIns))
+    {
+        reportFault(options, "invalid register or target", vm->PC - 1);
+        return -1;
+    }
+
+    switch(ins.op)
+    {
+        case LIT: vm->RF[ins.r] = ins.m; break;
+        case RTN:
+            // The dynamic link and the return address must both be on the stack
+            if(!isStackIndex(vm->BP + 2) || !isStackIndex(vm->BP + 3)) goto stackFault;
+
+            if(vm->stack[vm->BP + 3] < 0 || vm->stack[vm->BP + 3] > numOfIns)
+            {
+                reportFault(options, "return address is outside the code", vm->PC - 1);
+                return -1;
+            }
+
+            vm->SP = vm->BP - 1;
+            vm->BP = vm->stack[vm->SP + 3];
+            vm->PC = vm->stack[vm->SP + 4];
+            break;
+        case LOD:
+            if(findBasePointer(vm->stack, vm->BP, ins.l, &base)) goto staticLinkFault;
+            if(!isStackIndex(base + ins.m)) goto stackFault;
+            vm->RF[ins.r] = vm->stack[base + ins.m];
+            break;
+        case STO:
+            if(findBasePointer(vm->stack, vm->BP, ins.l, &base)) goto staticLinkFault;
+            if(!isStackIndex(base + ins.m)) goto stackFault;
+            vm->stack[base + ins.m] = vm->RF[ins.r];
+            break;
+        case CAL:
+            if(findBasePointer(vm->stack, vm->BP, ins.l, &base)) goto staticLinkFault;
+            if(!isStackIndex(vm->SP + 1) || !isStackIndex(vm->SP + 4)) goto stackFault;
+            vm->stack[vm->SP + 1] = 0;
+            vm->stack[vm->SP + 2] = base;
+            vm->stack[vm->SP + 3] = vm->BP;
+            vm->stack[vm->SP + 4] = vm->PC;
+            vm->BP = vm->SP + 1;
+            vm->PC = ins.m;
+            break;
+        case INC:
+            if(!isStackIndex(vm->SP + ins.m))
+            {
+                reportFault(options, "stack overflow", vm->PC - 1);
+                return -1;
+            }
+            vm->SP += ins.m;
+            break;
+        case JMP: vm->PC = ins.m; break;
+        case JPC: if(vm->RF[ins.r] == 0) vm->PC = ins.m; break;
+        case SIO_WRITE: fprintf(vmOut, "%d ", vm->RF[ins.r]); break;
+        case SIO_READ: fscanf(vmIn, "%d", &vm->RF[ins.r]); break;
+        case SIO_HALT: return 1;
+        case NEG: vm->RF[ins.r] = (int)(0u - (unsigned)vm->RF[ins.l]); break;
+        case ADD: vm->RF[ins.r] = (int)((unsigned)vm->RF[ins.l] + (unsigned)vm->RF[ins.m]); break;
+        case SUB: vm->RF[ins.r] = (int)((unsigned)vm->RF[ins.l] - (unsigned)vm->RF[ins.m]); break;
+        case MUL: vm->RF[ins.r] = (int)((unsigned)vm->RF[ins.l] * (unsigned)vm->RF[ins.m]); break;
+        case DIV:
+            if(vm->RF[ins.m] == 0 || (vm->RF[ins.l] == INT_MIN && vm->RF[ins.m] == -1)) goto divisionFault;
+            vm->RF[ins.r] = vm->RF[ins.l] / vm->RF[ins.m];
+            break;
+        case ODD: vm->RF[ins.r] = vm->RF[ins.r] % 2; break;
+        case MOD:
+            if(vm->RF[ins.m] == 0 || (vm->RF[ins.l] == INT_MIN && vm->RF[ins.m] == -1)) goto divisionFault;
+            vm->RF[ins.r] = vm->RF[ins.l] % vm->RF[ins.m];
+            break;
+        case EQL: vm->RF[ins.r] = vm->RF[ins.l] == vm->RF[ins.m]; break;
+        case NEQ: vm->RF[ins.r] = vm->RF[ins.l] != vm->RF[ins.m]; break;
+        case LSS: vm->RF[ins.r] = vm->RF[ins.l] <  vm->RF[ins.m]; break;
+        case LEQ: vm->RF[ins.r] = vm->RF[ins.l] <= vm->RF[ins.m]; break;
+        case GTR: vm->RF[ins.r] = vm->RF[ins.l] >  vm->RF[ins.m]; break;
+        case GEQ: vm->RF[ins.r] = vm->RF[ins.l] >= vm->RF[ins.m]; break;
+        default:
+            fprintf(options->faultOutp ? options->faultOutp : stderr, "VM cannot execute illegal instruction with op code: %d\n", ins.op);
+            fprintf(options->faultOutp ? options->faultOutp : stderr, "Terminating VM..\n");
+            return -1;
+    }
+
+    return 0;
+
+stackFault:
+    reportFault(options, "stack access is outside the stack", vm->PC - 1);
+    return -1;
+
+staticLinkFault:
+    reportFault(options, "static link is outside the stack", vm->PC - 1);
+    return -1;
+
+divisionFault:
+    reportFault(options, "division overflow or by zero", vm->PC - 1);
+    return -1;
+}
+
+/**
+ * One executed instruction, as recorded by the VM_TRACE_LAST mode.
+ * */
+typedef struct {
+    int lastPC;
+    Instruction ins;
+    int PC, BP, SP;
+} TraceStep;
+
+/**
+ * Writes the execution history line of the given step. The stack is only
+ * .. written if it is given.
+ * */
+static void dumpStep(FILE* out, const TraceStep* step, int* stack)
+{
+    fprintf(out, "%3d %3s %3d %3d %3d %3d %3d %3d ",
+        step->lastPC, getOpcodeName(step->ins.op), step->ins.r, step->ins.l, step->ins.m, step->PC, step->BP, step->SP);
+
+    if(stack) dumpStack(out, stack, step->SP, step->BP);
+
+    fputc('\n', out);
+}
+
+/**
+ * Runs the given program on a VirtualMachine, one executeInstruction() at a
+ * .. time, writing the execution history selected by the options.
+ * Returns 0 if the program halts or returns from the main block, -2 if it
+ * .. goes over its budget, -1 on any other fault.
+ * */
+static int traceProgram(const Instruction* code, int numOfIns, FILE* outp, FILE* vm_inp, FILE* vm_outp, VMOptions options)
+{
+    // The last traceLength steps, stored circularly
+    TraceStep* ring = NULL;
+    long long step = 0;
+
+    if(options.trace == VM_TRACE_LAST)
+    {
+        if( !(ring = (TraceStep*)malloc(options.traceLength * sizeof(TraceStep))) )
+        {
+            fprintf(stderr, "Could not allocate space for the trace.\n");
+            return -1;
+        }
+    }
+
+    dumpInstructions(outp, code, numOfIns);
+
+    fprintf(outp, "\n***Execution***\n");
+    fprintf(outp, "%3s %3s %3s %3s %3s %3s %3s %3s %3s \n", "#", "OP", "R", "L", "M", "PC", "BP", "SP", "STK");
+
+    VirtualMachine vm;
+    initVM(&vm);
+
+    Budget budget;
+    initBudget(&budget, options, VM_TRACED_CLOCK_CHECK_INTERVAL);
+
+    int halt = 0;
+    int outOfBudget = 0;
+
+    // Run until halted, faulted or returned from the main block
+    while(halt == 0 && (vm.PC != 0 || vm.BP != 0 || vm.SP != 0))
+    {
+        TraceStep current;
+
+        current.lastPC = vm.PC;
+
+        // Jumps and returns are checked to stay within the code, so only
+        // .. running past the last instruction can leave it
+        if(vm.PC < 0 || vm.PC >= numOfIns)
+        {
+            reportFault(&options, "execution reached the end of the code", vm.PC);
+            halt = -1;
+            break;
+        }
+
+        const char* fault;
+        if(step + 1 >= budget.checkpoint && (fault = checkBudget(&budget, step + 1)) != NULL)
+        {
+            reportFault(&options, fault, vm.PC);
+            halt = -1;
+            outOfBudget = 1;
+            break;
+        }
+
+        current.ins = code[vm.PC];
+        vm.PC++;
+
+        halt = executeInstruction(&vm, current.ins, numOfIns, vm_inp, vm_outp, &options);
+
+        if(halt < 0) break;
+
+        current.PC = vm.PC;
+        current.BP = vm.BP;
+        current.SP = vm.SP;
+
+        if(options.trace == VM_TRACE_FULL || (options.trace == VM_TRACE_SAMPLED && step % options.traceLength == 0))
+            dumpStep(outp, &current, vm.stack);
+        else if(options.trace == VM_TRACE_LAST)
+            ring[step % options.traceLength] = current;
+
+        step++;
+    }
+
+    if(options.trace == VM_TRACE_LAST)
+    {
+        long long first = step > options.traceLength ? step - options.traceLength : 0;
+
+        if(first > 0) fprintf(outp, "(%lld earlier steps omitted)\n", first);
+
+        for(long long i = first; i < step; i++)
+            dumpStep(outp, &ring[i % options.traceLength], NULL);
+
+        // The stack is only known at the end of the run
+        fprintf(outp, "%3s ", "STK");
+        dumpStack(outp, vm.stack, vm.SP, vm.BP);
+        fputc('\n', outp);
+
+        free(ring);
+    }
+
+    // A faulted run ends without the halt marker
+    if(halt >= 0) fprintf(outp, "HLT\n");
+
+    if(outOfBudget) return -2;
+
+    return halt < 0 ? -1 : 0;
+}
+
+/**
+ * Runs the given machine one instruction at a time, as traceProgram() does
+ * .. but without the trace, from the given number of executed instructions
+ * .. until it halts, faults or goes over its budget.
+ * Returns as executeProgram() does.
+ * */
+static int finishWithinBudget(VirtualMachine* vm, const Instruction* code, int numOfIns, long long step, Budget* budget, FILE* vmIn, FILE* vmOut, const VMOptions* options)
+{
+    int halt = 0;
+
+    while(halt == 0 && (vm->PC != 0 || vm->BP != 0 || vm->SP != 0))
+    {
+        if(vm->PC < 0 || vm->PC >= numOfIns)
+        {
+            reportFault(options, "execution reached the end of the code", vm->PC);
+            return -1;
+        }
+
+        const char* fault;
+        if(step + 1 >= budget->checkpoint && (fault = checkBudget(budget, step + 1)) != NULL)
+        {
+            reportFault(options, fault, vm->PC);
+            return -2;
+        }
+
+        Instruction ins = code[vm->PC];
+        vm->PC++;
+
+        halt = executeInstruction(vm, ins, numOfIns, vmIn, vmOut, options);
+        step++;
+    }
+
+    return halt < 0 ? -1 : 0;
+}
+
+/**
+ * Executes the given program without producing any trace. The state of the
+ * .. machine is kept in local variables, and every instruction is validated
+ * .. once when it is loaded rather than each time it is executed. Runtime
+ * .. faults are reported as executeInstruction() reports them.
+ * The executed instructions are only counted where control is transferred,
+ * .. by adding up the lengths of the straight-line runs, so keeping to the
+ * .. budget costs nothing between jumps. The length of each run is known
+ * .. from the load, and a run that would go over the instruction budget is
+ * .. executed by finishWithinBudget() instead, so that the program stops at
+ * .. the same instruction, with the same output, as in the traced path.
+ * Returns 0 if the program halts or returns from the main block, -2 if it
+ * .. goes over its budget, -1 on any other fault.
+ * */
+static int executeProgram(const Instruction* code, int numOfIns, VMOptions options, FILE* vmIn, FILE* vmOut)
+{
+#if VM_DIRECT_THREADED
+    static const void* const handlers[NUMBER_OF_HANDLERS] = {
+        [0] = &&target_INVALID,
+        [LIT] = &&target_LIT, [RTN] = &&target_RTN, [LOD] = &&target_LOD, [STO] = &&target_STO,
+        [CAL] = &&target_CAL, [INC] = &&target_INC, [JMP] = &&target_JMP, [JPC] = &&target_JPC,
+        [SIO_WRITE] = &&target_SIO_WRITE, [SIO_READ] = &&target_SIO_READ, [SIO_HALT] = &&target_SIO_HALT,
+        [NEG] = &&target_NEG, [ADD] = &&target_ADD, [SUB] = &&target_SUB, [MUL] = &&target_MUL,
+        [DIV] = &&target_DIV, [ODD] = &&target_ODD, [MOD] = &&target_MOD, [EQL] = &&target_EQL,
+        [NEQ] = &&target_NEQ, [LSS] = &&target_LSS, [LEQ] = &&target_LEQ, [GTR] = &&target_GTR,
+        [GEQ] = &&target_GEQ, [INVALID] = &&target_INVALID, [END_OF_CODE] = &&target_END_OF_CODE,
+        [LOD_WRITE] = &&target_LOD_WRITE, [LOD_LIT_ADD_STO] = &&target_LOD_LIT_ADD_STO,
+        [LOD_LIT_SUB_STO] = &&target_LOD_LIT_SUB_STO, [EQL_JPC] = &&target_EQL_JPC,
+        [NEQ_JPC] = &&target_NEQ_JPC, [LSS_JPC] = &&target_LSS_JPC, [LEQ_JPC] = &&target_LEQ_JPC,
+        [GTR_JPC] = &&target_GTR_JPC, [GEQ_JPC] = &&target_GEQ_JPC
+    };
+    #define TARGET(op) case op: target_##op
+#if VM_PACKED_INSTRUCTIONS
+    #define DISPATCH() do { ins = &program[PC++]; goto *handlers[ins->op]; } while(0)
+#else
+    #define DISPATCH() do { ins = &program[PC++]; goto *ins->handler; } while(0)
+#endif
+#else
+    #define TARGET(op) case op
+    #define DISPATCH() goto dispatch
+#endif
+
+    // The loaded program, followed by an instruction marking the end of the code
+    ThreadedInstruction* program = (ThreadedInstruction*)malloc((numOfIns + 1) * sizeof(ThreadedInstruction));
+
+    // The number of instructions executed from each one up to the next
+    // .. unconditional transfer of control, past the conditional jumps that
+    // .. fall through. No run is longer.
+    int* runLength = (int*)malloc((numOfIns + 1) * sizeof(int));
+
+    if(!program || !runLength)
+    {
+        fprintf(stderr, "Could not allocate space for the instructions.\n");
+        free(program);
+        free(runLength);
+        return -1;
+    }
+
+    runLength[numOfIns] = 0;
+
+    for(int i = numOfIns - 1; i >= 0; i--)
+    {
+        int op = code[i].op;
+        int endsRun = op == JMP || op == CAL || op == RTN || op == SIO_HALT;
+
+        runLength[i] = endsRun ? 1 : runLength[i + 1] + 1;
+    }
+
+    for(int i = 0; i <= numOfIns; i++)
+    {
+        ThreadedInstruction* loaded = &program[i];
+
+        if(i == numOfIns)
+            *loaded = (ThreadedInstruction){ .op = END_OF_CODE };
+        else if(!isInstructionValid(code[i], numOfIns))
+            *loaded = (ThreadedInstruction){ .op = INVALID, .m = code[i].op };
+        else
+            *loaded = (ThreadedInstruction){ .op = code[i].op, .r = code[i].r, .l = code[i].l, .m = code[i].m };
+    }
+
+    if(options.fuseInstructions) fuseInstructions(program, numOfIns);
+
+#if VM_DIRECT_THREADED && !VM_PACKED_INSTRUCTIONS
+    for(int i = 0; i <= numOfIns; i++)
+        program[i].handler = handlers[program[i].op];
+#endif
+
+    // The registers and the stack of the machine, as in initVM()
+    int BP = 1, SP = 0, PC = 0;
+    int RF[REGISTER_FILE_REG_COUNT] = { 0 };
+    int stack[MAX_STACK_HEIGHT] = { 0 };
+
+    const ThreadedInstruction* ins;
+    const char* fault = NULL;
+    int base, i;
+
+    // The display: display[k] is the base pointer of the activation record
+    // .. at static nesting depth k on the static chain of the current record,
+    // .. whose depth is level. It resolves the static links in constant time,
+    // .. as long as it agrees with the static links on the stack: if a store
+    // .. overwrites a live static link, a return does not match its call or
+    // .. the calls nest too deep, the display is abandoned for the rest of the
+    // .. run and the static links are walked instead.
+    int useDisplay = 1;
+    int display[VM_DISPLAY_SIZE];
+    int level = 0;
+
+    display[0] = BP;
+
+    // What each call overwrote in the display, restored by its return
+    struct {
+        int BP;           // the base pointer of the callee
+        int callerBP;
+        int callerLevel;
+        int displayEntry; // display[level of the callee] before the call
+    } calls[VM_MAX_CALL_DEPTH];
+    int callDepth = 0;
+
+    // Whether each stack slot holds the static link of a called record
+    unsigned char isStaticLink[MAX_STACK_HEIGHT] = { 0 };
+
+    // The number of executed instructions is stepBase + PC: every transfer
+    // .. of control adds the length of the straight-line run it ends and
+    // .. subtracts its target
+    Budget budget;
+    long long stepBase = 0;
+    long long checkpoint;
+    int outOfBudget = 0;
+
+    initBudget(&budget, options, VM_CLOCK_CHECK_INTERVAL);
+    checkpoint = budget.checkpoint;
+
+    // Sets base to the base pointer L levels down, as findBasePointer() does.
+    // Faults if a static link is outside the stack.
+    #define FIND_BASE(L) \
+        if((L) <= level && useDisplay) \
+        { \
+            base = display[level - (L)]; \
+        } \
+        else \
+        { \
+            for(base = BP, i = (L); i > 0; i--) \
+            { \
+                if(base + 1 < 0 || base + 1 >= MAX_STACK_HEIGHT) { fault = "static link is outside the stack"; goto done; } \
+                base = stack[base + 1]; \
+            } \
+        }
+
+    // Stores the value at the given stack index, which has to be checked
+    #define STORE(x, value) \
+        if(isStaticLink[x]) useDisplay = 0; \
+        stack[x] = (value);
+
+    // Faults if the given stack index is outside the stack
+    #define CHECK_STACK_INDEX(x) \
+        if((x) < 0 || (x) >= MAX_STACK_HEIGHT) { fault = "stack access is outside the stack"; goto done; }
+
+    // Checks the budget if the run starting at PC can reach the checkpoint.
+    // .. A run that can go over the instruction budget is left to
+    // .. finishWithinBudget().
+    #define CHECK_RUN() \
+        if(stepBase + PC + runLength[PC] >= checkpoint) \
+        { \
+            if((fault = checkBudget(&budget, stepBase + PC)) != NULL) { outOfBudget = 1; goto done; } \
+            checkpoint = budget.checkpoint; \
+            if(budget.maxSteps > 0 && stepBase + PC + runLength[PC] > budget.maxSteps) goto lastRun; \
+        }
+
+    // Transfers control to the given instruction, counting the run that ends
+    // .. here and checking the budget for the one that starts
+    #define JUMP_TO(target) \
+        { \
+            stepBase += PC; \
+            PC = (target); \
+            stepBase -= PC; \
+            CHECK_RUN(); \
+        }
+
+    CHECK_RUN();
+    DISPATCH();
+
+#if !VM_DIRECT_THREADED
+dispatch:
+    ins = &program[PC++];
+#endif
+
+    switch(ins->op)
+    {
+        TARGET(LIT):
+            RF[ins->r] = ins->m;
+            DISPATCH();
+
+        TARGET(RTN):
+            CHECK_STACK_INDEX(BP + 2);
+            CHECK_STACK_INDEX(BP + 3);
+
+            // Checked before the jump, which looks up the run it returns to
+            if(stack[BP + 3] < 0 || stack[BP + 3] > numOfIns) { fault = "return address is outside the code"; goto done; }
+
+            SP = BP - 1;
+            BP = stack[SP + 3];
+
+            if(useDisplay && callDepth > 0)
+            {
+                callDepth--;
+
+                if(calls[callDepth].BP != SP + 1 || calls[callDepth].callerBP != BP)
+                {
+                    useDisplay = 0;
+                }
+                else
+                {
+                    isStaticLink[SP + 2] = 0;
+                    display[level] = calls[callDepth].displayEntry;
+                    level = calls[callDepth].callerLevel;
+                }
+            }
+
+            // Returning from the main block ends the program
+            if(stack[SP + 4] == 0 && BP == 0 && SP == 0) { stepBase += PC; PC = 0; goto done; }
+
+            JUMP_TO(stack[SP + 4]);
+            DISPATCH();
+
+        TARGET(LOD):
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            RF[ins->r] = stack[base + ins->m];
+            DISPATCH();
+
+        TARGET(STO):
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            STORE(base + ins->m, RF[ins->r]);
+            DISPATCH();
+
+        TARGET(CAL):
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(SP + 1);
+            CHECK_STACK_INDEX(SP + 4);
+            STORE(SP + 1, 0);
+            STORE(SP + 2, base);
+            STORE(SP + 3, BP);
+            STORE(SP + 4, PC);
+
+            if(useDisplay)
+            {
+                // The callee is nested right inside the record base belongs to
+                int calleeLevel = level - ins->l + 1;
+
+                if(ins->l > level || calleeLevel >= VM_DISPLAY_SIZE || callDepth == VM_MAX_CALL_DEPTH)
+                {
+                    useDisplay = 0;
+                }
+                else
+                {
+                    calls[callDepth].BP = SP + 1;
+                    calls[callDepth].callerBP = BP;
+                    calls[callDepth].callerLevel = level;
+                    calls[callDepth].displayEntry = display[calleeLevel];
+                    callDepth++;
+
+                    isStaticLink[SP + 2] = 1;
+                    display[calleeLevel] = SP + 1;
+                    level = calleeLevel;
+                }
+            }
+
+            BP = SP + 1;
+            JUMP_TO(ins->m);
+            DISPATCH();
+
+        TARGET(INC):
+            SP += ins->m;
+            if(SP < 0 || SP >= MAX_STACK_HEIGHT) { fault = "stack overflow"; goto done; }
+            DISPATCH();
+
+        TARGET(JMP):
+            JUMP_TO(ins->m);
+            DISPATCH();
+
+        TARGET(JPC):
+            if(RF[ins->r] == 0) JUMP_TO(ins->m);
+            DISPATCH();
+
+        TARGET(SIO_WRITE):
+            fprintf(vmOut, "%d ", RF[ins->r]);
+            DISPATCH();
+
+        TARGET(SIO_READ):
+            fscanf(vmIn, "%d", &RF[ins->r]);
+            DISPATCH();
+
+        TARGET(SIO_HALT):
+            goto done;
+
+        // Overflowing arithmetic wraps around, as it does in executeInstruction()
+        TARGET(NEG):
+            RF[ins->r] = (int)(0u - (unsigned)RF[ins->l]);
+            DISPATCH();
+
+        TARGET(ADD):
+            RF[ins->r] = (int)((unsigned)RF[ins->l] + (unsigned)RF[ins->m]);
+            DISPATCH();
+
+        TARGET(SUB):
+            RF[ins->r] = (int)((unsigned)RF[ins->l] - (unsigned)RF[ins->m]);
+            DISPATCH();
+
+        TARGET(MUL):
+            RF[ins->r] = (int)((unsigned)RF[ins->l] * (unsigned)RF[ins->m]);
+            DISPATCH();
+
+        TARGET(DIV):
+            if(RF[ins->m] == 0 || (RF[ins->l] == INT_MIN && RF[ins->m] == -1)) { fault = "division overflow or by zero"; goto done; }
+            RF[ins->r] = RF[ins->l] / RF[ins->m];
+            DISPATCH();
+
+        TARGET(ODD):
+            RF[ins->r] = RF[ins->r] % 2;
+            DISPATCH();
+
+        TARGET(MOD):
+            if(RF[ins->m] == 0 || (RF[ins->l] == INT_MIN && RF[ins->m] == -1)) { fault = "division overflow or by zero"; goto done; }
+            RF[ins->r] = RF[ins->l] % RF[ins->m];
+            DISPATCH();
+
+        TARGET(EQL):
+            RF[ins->r] = RF[ins->l] == RF[ins->m];
+            DISPATCH();
+
+        TARGET(NEQ):
+            RF[ins->r] = RF[ins->l] != RF[ins->m];
+            DISPATCH();
+
+        TARGET(LSS):
+            RF[ins->r] = RF[ins->l] < RF[ins->m];
+            DISPATCH();
+
+        TARGET(LEQ):
+            RF[ins->r] = RF[ins->l] <= RF[ins->m];
+            DISPATCH();
+
+        TARGET(GTR):
+            RF[ins->r] = RF[ins->l] > RF[ins->m];
+            DISPATCH();
+
+        TARGET(GEQ):
+            RF[ins->r] = RF[ins->l] >= RF[ins->m];
+            DISPATCH();
+
+        // Superinstructions: ins is advanced to each instruction of the
+        // .. sequence which may fault, so that faults are reported at it
+        TARGET(LOD_WRITE):
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            RF[ins->r] = stack[base + ins->m];
+            fprintf(vmOut, "%d ", RF[ins[1].r]);
+            PC += 1;
+            DISPATCH();
+
+        TARGET(LOD_LIT_ADD_STO):
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            RF[ins->r] = stack[base + ins->m];
+            RF[ins[1].r] = ins[1].m;
+            RF[ins[2].r] = (int)((unsigned)RF[ins[2].l] + (unsigned)RF[ins[2].m]);
+            ins += 3;
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            STORE(base + ins->m, RF[ins->r]);
+            PC += 3;
+            DISPATCH();
+
+        TARGET(LOD_LIT_SUB_STO):
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            RF[ins->r] = stack[base + ins->m];
+            RF[ins[1].r] = ins[1].m;
+            RF[ins[2].r] = (int)((unsigned)RF[ins[2].l] - (unsigned)RF[ins[2].m]);
+            ins += 3;
+            FIND_BASE(ins->l);
+            CHECK_STACK_INDEX(base + ins->m);
+            STORE(base + ins->m, RF[ins->r]);
+            PC += 3;
+            DISPATCH();
+
+        // A comparison followed by a conditional jump
+        #define COMPARE_AND_JUMP(cmp) \
+            RF[ins->r] = RF[ins->l] cmp RF[ins->m]; \
+            PC += 1; \
+            if(RF[ins[1].r] == 0) JUMP_TO(ins[1].m); \
+            DISPATCH();
+
+        TARGET(EQL_JPC): COMPARE_AND_JUMP(==)
+        TARGET(NEQ_JPC): COMPARE_AND_JUMP(!=)
+        TARGET(LSS_JPC): COMPARE_AND_JUMP(<)
+        TARGET(LEQ_JPC): COMPARE_AND_JUMP(<=)
+        TARGET(GTR_JPC): COMPARE_AND_JUMP(>)
+        TARGET(GEQ_JPC): COMPARE_AND_JUMP(>=)
+
+        #undef COMPARE_AND_JUMP
+
+        TARGET(END_OF_CODE):
+            fault = "execution reached the end of the code";
+            goto done;
+
+        // The original opcode of an invalid instruction is kept in m
+        TARGET(INVALID):
+        default:
+            if(ins->m > 0 && ins->m < NUMBER_OF_OPCODES)
+            {
+                fault = "invalid register or target";
+            }
+            else
+            {
+                fprintf(options.faultOutp ? options.faultOutp : stderr, "VM cannot execute illegal instruction with op code: %d\n", (int)ins->m);
+                fault = "illegal instruction";
+            }
+            goto done;
+    }
+
+done:
+    // The run ending here, including the instruction that ended it
+    if(!fault && budget.maxSteps > 0 && stepBase + PC > budget.maxSteps)
+    {
+        fault = "instruction budget exceeded";
+        outOfBudget = 1;
+    }
+
+    if(fault) reportFault(&options, fault, (int)(ins - program));
+
+    free(program);
+    free(runLength);
+
+    if(outOfBudget) return -2;
+
+    return fault ? -1 : 0;
+
+lastRun:
+    {
+        // The state of the machine is handed over as it is kept on the stack;
+        // .. the display only mirrors it
+        VirtualMachine vm;
+
+        vm.BP = BP;
+        vm.SP = SP;
+        vm.PC = PC;
+        vm.IR = 0;
+        memcpy(vm.RF, RF, sizeof(RF));
+        memcpy(vm.stack, stack, sizeof(stack));
+
+        free(program);
+        free(runLength);
+
+        return finishWithinBudget(&vm, code, numOfIns, stepBase + PC, &budget, vmIn, vmOut, &options);
+    }
+
+    #undef TARGET
+    #undef DISPATCH
+    #undef FIND_BASE
+    #undef STORE
+    #undef CHECK_STACK_INDEX
+    #undef CHECK_RUN
+    #undef JUMP_TO
+}
+
+VMOptions getDefaultVMOptions()
+{
+    VMOptions options;
+
+    options.trace = VM_TRACE_FULL;
+    options.traceLength = 1;
+    options.fuseInstructions = 1;
+    options.maxSteps = 0;
+    options.timeLimit = 0;
+    options.faultOutp = NULL;
+    options.symbols = NULL;
+
+    return options;
+}
+
+int runProgram(const Instruction* code, int numOfIns, FILE* outp, FILE* vm_inp, FILE* vm_outp, VMOptions options)
+{
+    if(options.trace != VM_TRACE_FULL && options.trace != VM_TRACE_OFF && options.traceLength < 1)
+    {
+        fprintf(stderr, "The trace length must be positive.\n");
+        return -1;
+    }
+
+    if(options.trace == VM_TRACE_OFF)
+        return executeProgram(code, numOfIns, options, vm_inp, vm_outp);
+    else
+        return traceProgram(code, numOfIns, outp, vm_inp, vm_outp, options);
+}
+
+int runVMWithOptions(FILE* inp, FILE* outp, FILE* vm_inp, FILE* vm_outp, VMOptions options)
+{
+    if(isCodeObject(inp))
+    {
+        CodeObject object;
+
+        if(openCodeObject(inp, &object))
+        {
+            fprintf(stderr, "The instructions are not a valid PM/0 object.\n");
+            return -1;
+        }
+
+        if(!options.symbols) options.symbols = &object;
+
+        int result = runProgram(object.instructions, object.numberOfInstructions, outp, vm_inp, vm_outp, options);
+
+        closeCodeObject(&object);
+
+        return result;
+    }
+
+    int numOfIns;
+    Instruction* ins = readInstructions(inp, &numOfIns);
+
+    if(!ins)
+    {
+        fprintf(stderr, "Could not allocate space for the instructions.\n");
+        return -1;
+    }
+
+    int result = runProgram(ins, numOfIns, outp, vm_inp, vm_outp, options);
+
+    free(ins);
+
+    return result;
+}
+
+void simulateVM(FILE* inp, FILE* outp, FILE* vm_inp, FILE* vm_outp)
+{
+    runVMWithOptions(inp, outp, vm_inp, vm_outp, getDefaultVMOptions());
+}
+
+int runVM(FILE* inp, FILE* vm_inp, FILE* vm_outp)
+{
+    VMOptions options = getDefaultVMOptions();
+
+    options.trace = VM_TRACE_OFF;
+
+    return runVMWithOptions(inp, NULL, vm_inp, vm_outp, options);
+}
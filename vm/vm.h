@@ -2,6 +2,52 @@
 #define __VM_H__
 
 #include <stdio.h>
+#include "data.h"
+#include "../code_object.h"
+
+/**
+ * The execution history written to the simulation output:
+ *  VM_TRACE_FULL:    every executed instruction, as simulateVM() does
+ *  VM_TRACE_OFF:     nothing; not even the code memory is written
+ *  VM_TRACE_SAMPLED: every traceLength-th executed instruction
+ *  VM_TRACE_LAST:    the last traceLength executed instructions, kept in
+ *                    .. memory and written once the program halts or faults,
+ *                    .. followed by the final stack
+ * */
+typedef enum {
+    VM_TRACE_FULL,
+    VM_TRACE_OFF,
+    VM_TRACE_SAMPLED,
+    VM_TRACE_LAST
+} VMTraceMode;
+
+typedef struct {
+    VMTraceMode trace;
+    int traceLength; // the sampling interval or the number of steps kept
+
+    // Whether common instruction sequences are executed as single fused
+    // .. instructions. Only applies when the trace is off.
+    int fuseInstructions;
+
+    // The budget of the run: the most instructions the program may execute
+    // .. and the most seconds it may run, 0 for no limit. A program going
+    // .. over either is stopped as a fault.
+    long long maxSteps;
+    double timeLimit;
+
+    // Where runtime faults are reported, stderr if NULL
+    FILE* faultOutp;
+
+    // The object whose symbols name the procedure a fault happens in, NULL
+    // .. if the program has none
+    const CodeObject* symbols;
+} VMOptions;
+
+/**
+ * Returns the default options, which write the full execution history and
+ * .. fuse instructions, without a budget.
+ * */
+VMOptions getDefaultVMOptions();
 
 /**
  * inp: The FILE pointer containing the list of instructions to
@@ -26,4 +72,67 @@ void simulateVM(
     FILE* vm_outp
 );
 
-#endif
\ No newline at end of file
+/**
+ * Runs the list of instructions in inp, writing the simulation output to
+ * .. outp as selected by the given options. outp is not used when the trace
+ * .. is off, and may be NULL.
+ * inp holds either "op r l m" lines or a binary PM/0 object (see
+ * .. code_object.h), which is told apart by its magic. An object is loaded
+ * .. without parsing, and its symbols are used in fault reports unless the
+ * .. options already give some.
+ * 
+ * Invalid instructions and runtime faults, such as stack overflow or division
+ * .. by zero, stop the program and are reported on options.faultOutp.
+ * 
+ * Returns 0 if the program halts or returns from its main block, -2 if it
+ * .. goes over its budget, -1 on any other fault.
+ * */
+
+int runVMWithOptions(
+    FILE* inp,
+    FILE* outp,
+    FILE* vm_inp,
+    FILE* vm_outp,
+    VMOptions options
+);
+
+/**
+ * Reads the instructions from the given file until EOF into a new allocation,
+ * .. which the caller should free. Sets numOfIns to the number of
+ * .. instructions read. Returns NULL if the allocation fails.
+ * */
+
+Instruction* readInstructions(FILE* inp, int* numOfIns);
+
+/**
+ * Runs the given instructions, which are already in memory, exactly as
+ * .. runVMWithOptions() runs the instructions it reads. The instructions are
+ * .. not modified.
+ * All the state of a run is local to the call, so different programs can be
+ * .. run concurrently.
+ * */
+
+int runProgram(
+    const Instruction* code,
+    int numOfIns,
+    FILE* outp,
+    FILE* vm_inp,
+    FILE* vm_outp,
+    VMOptions options
+);
+
+/**
+ * Runs the list of instructions in inp without writing any simulation
+ * .. output, which is much faster than simulateVM() for long running
+ * .. programs. The program reads from vm_inp and writes to vm_outp exactly as
+ * .. it does under simulateVM(). The same as runVMWithOptions() with the
+ * .. trace off.
+ * */
+
+int runVM(
+    FILE* inp,
+    FILE* vm_inp,
+    FILE* vm_outp
+);
+
+#endif
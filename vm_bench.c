@@ -0,0 +1,272 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "source_code.h"
+#include "lexical_analyzer.h"
+#include "code_generator.h"
+#include "vm/vm.h"
+
+/**
+ * VM throughput benchmark. Compiles loop-heavy PL/0 programs in memory and
+ * .. measures how fast the VM runs them with the trace off. Built once with
+ * .. the packed instruction layout and once with VM_UNPACKED_INSTRUCTIONS
+ * .. (see vm.c), so that make bench_vm compares the two layouts.
+ * */
+
+#define DEFAULT_SCALE 1
+#define DEFAULT_REPETITIONS 5
+
+/**
+ * The number of statements in the body of the generated long loop, whose
+ * .. code is far larger than the L1 cache in either layout.
+ * */
+#define LONG_LOOP_STATEMENTS 1500
+#define LONG_LOOP_ITERATIONS 2000
+
+/**
+ * The benchmark programs. Each reads the number of iterations of its loop,
+ * .. which is the given count times the scale, and writes a checksum.
+ * */
+static const struct {
+    const char* name;
+    int iterations;
+    const char* source;
+} programs[] = {
+    { "Counting loop", 20000000,
+        "var i, n, s;\n"
+        "begin\n"
+        "    read n;\n"
+        "    i := 0; s := 0;\n"
+        "    while i < n do\n"
+        "    begin\n"
+        "        s := s + i;\n"
+        "        i := i + 1\n"
+        "    end;\n"
+        "    write s\n"
+        "end.\n" },
+
+    { "Trial division", 20000,
+        "var n, p, d, isPrime, count;\n"
+        "begin\n"
+        "    read n;\n"
+        "    p := 2; count := 0;\n"
+        "    while p < n do\n"
+        "    begin\n"
+        "        d := 2; isPrime := 1;\n"
+        "        while d * d <= p do\n"
+        "        begin\n"
+        "            if p - p / d * d = 0 then isPrime := 0;\n"
+        "            d := d + 1\n"
+        "        end;\n"
+        "        count := count + isPrime;\n"
+        "        p := p + 1\n"
+        "    end;\n"
+        "    write count\n"
+        "end.\n" },
+
+    { "Nested procedure calls", 2000000,
+        "var i, n, s;\n"
+        "procedure step;\n"
+        "    var t;\n"
+        "    procedure add;\n"
+        "    begin\n"
+        "        s := s + t\n"
+        "    end;\n"
+        "begin\n"
+        "    t := i;\n"
+        "    if odd i then t := 0 - t;\n"
+        "    call add\n"
+        "end;\n"
+        "begin\n"
+        "    read n;\n"
+        "    i := 0; s := 0;\n"
+        "    while i < n do\n"
+        "    begin\n"
+        "        call step;\n"
+        "        i := i + 1\n"
+        "    end;\n"
+        "    write s\n"
+        "end.\n" }
+};
+
+/**
+ * Builds a program like the counting loop, but whose loop body is made of
+ * .. the given number of statements. Returns NULL if the allocation fails.
+ * */
+char* buildLongLoopSource(int statements)
+{
+    const char* header = "var i, n, a, b;\nbegin\n    read n;\n    i := 0; a := 1; b := 0;\n    while i < n do\n    begin\n";
+    const char* footer = "        i := i + 1\n    end;\n    write a; write b\nend.\n";
+    const size_t statementLength = 48;
+
+    char* source = (char*)malloc(strlen(header) + (size_t)statements * statementLength + strlen(footer) + 1);
+
+    if(!source) return NULL;
+
+    char* end = source + sprintf(source, "%s", header);
+
+    for(int k = 0; k < statements; k++)
+    {
+        if(k % 2 == 0)
+            end += sprintf(end, "        a := a + i * %d;\n", k % 97 + 1);
+        else
+            end += sprintf(end, "        b := b - a / %d;\n", k % 89 + 1);
+    }
+
+    sprintf(end, "%s", footer);
+
+    return source;
+}
+
+/**
+ * Returns the number of seconds elapsed since an arbitrary point.
+ * */
+double getSeconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Compiles the given source into the given CodeBuffer.
+ * Returns 0 on success, -1 otherwise.
+ * */
+int compileSource(const char* source, CodeBuffer* code)
+{
+    SourceCode sourceCode;
+
+    sourceCode.text = source;
+    sourceCode.length = strlen(source);
+    sourceCode.mapping = NULL;
+    sourceCode.mappingLength = 0;
+
+    LexerOut lexerOut = lexicalAnalyzer(sourceCode);
+
+    if(lexerOut.lexerError != NONE)
+    {
+        printLexErr(lexerOut.lexerError, lexerOut.errorLine, stderr);
+        deleteLexerOut(&lexerOut);
+        return -1;
+    }
+
+    // Procedures are kept, so that calls are measured too
+    CodeGenOptions options = getDefaultCodeGenOptions();
+    options.inlineThreshold = 0;
+
+    int err = compileTokenList(lexerOut.tokenList, options, code);
+
+    if(err) printCGErr(err, stderr);
+
+    deleteLexerOut(&lexerOut);
+
+    return err ? -1 : 0;
+}
+
+/**
+ * Runs the given code repetitions times, reading the given number of
+ * .. iterations. Prints and returns the best time in seconds.
+ * Returns -1 if the program faults.
+ * */
+double benchmarkCode(const char* name, const CodeBuffer* code, int iterations, int repetitions)
+{
+    VMOptions options = getDefaultVMOptions();
+    options.trace = VM_TRACE_OFF;
+
+    char input[32];
+    char output[32] = "";
+    double best = 0;
+
+    snprintf(input, sizeof(input), "%d", iterations);
+
+    for(int r = 0; r < repetitions; r++)
+    {
+        FILE* vmIn = fmemopen(input, strlen(input), "r");
+        FILE* vmOut = fmemopen(output, sizeof(output), "w");
+
+        if(!vmIn || !vmOut)
+        {
+            fprintf(stderr, "Could not open the streams of the program\n");
+            if(vmIn) fclose(vmIn);
+            if(vmOut) fclose(vmOut);
+            return -1;
+        }
+
+        double start = getSeconds();
+        int result = runProgram(code->instructions, code->numberOfInstructions, NULL, vmIn, vmOut, options);
+        double elapsed = getSeconds() - start;
+
+        fclose(vmIn);
+        fclose(vmOut);
+
+        if(result) return -1;
+
+        if(best == 0 || elapsed < best) best = elapsed;
+    }
+
+    printf("  %-24s %8.1f ms %12d iterations, %7d instructions, wrote %s\n", name, best * 1e3, iterations, code->numberOfInstructions, output);
+
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    int scale = argc > 1 ? atoi(argv[1]) : DEFAULT_SCALE;
+    int repetitions = argc > 2 ? atoi(argv[2]) : DEFAULT_REPETITIONS;
+
+    if(scale <= 0 || repetitions <= 0)
+    {
+        fprintf(stderr, "Usage: ./vm_bench.out [scale] [repetitions]\n");
+        return -1;
+    }
+
+#if defined(VM_UNPACKED_INSTRUCTIONS)
+    printf("Unpacked instructions, best of %d runs\n", repetitions);
+#else
+    printf("Packed instructions, best of %d runs\n", repetitions);
+#endif
+
+    double total = 0;
+
+    for(size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++)
+    {
+        CodeBuffer code;
+
+        if(compileSource(programs[i].source, &code)) return -1;
+
+        double best = benchmarkCode(programs[i].name, &code, programs[i].iterations * scale, repetitions);
+
+        deleteCodeBuffer(&code);
+
+        if(best < 0) return -1;
+
+        total += best;
+    }
+
+    char* longLoopSource = buildLongLoopSource(LONG_LOOP_STATEMENTS);
+    CodeBuffer code;
+
+    if(!longLoopSource || compileSource(longLoopSource, &code))
+    {
+        free(longLoopSource);
+        return -1;
+    }
+
+    double best = benchmarkCode("Long loop body", &code, LONG_LOOP_ITERATIONS * scale, repetitions);
+
+    deleteCodeBuffer(&code);
+    free(longLoopSource);
+
+    if(best < 0) return -1;
+
+    total += best;
+
+    printf("  %-24s %8.1f ms\n", "Total", total * 1e3);
+
+    return 0;
+}